@@ -0,0 +1,195 @@
+/**
+ * TerminalTests
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+// Using catch2 headers
+
+#define CATCH_CONFIG_RUNNER
+
+#include "AnsiText.h"
+#include "Terminal.h"
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+using namespace BlackOS::DisplayKernel;
+
+namespace {
+void feed(Terminal &terminal, std::string const &bytes) {
+  terminal.feed(bytes.data(), bytes.size());
+}
+
+std::string rowText(Terminal const &terminal, size_t const y) {
+  std::string text;
+  for (size_t x = 0; x < terminal.cols(); ++x)
+    text += terminal.cell(y, x).ch;
+  return text;
+}
+} // namespace
+
+TEST_CASE("printable runs are written at the cursor and controls are applied",
+          "[terminal]") {
+  Terminal terminal(3, 40);
+  feed(terminal, "a line that is longer than sixteen bytes\r\nnext\tx");
+  REQUIRE(rowText(terminal, 0) == "a line that is longer than sixteen bytes");
+  REQUIRE(rowText(terminal, 1).substr(0, 9) == "next    x");
+  REQUIRE(terminal.cursorY() == 1);
+  REQUIRE(terminal.cursorX() == 9);
+}
+
+TEST_CASE("text wraps only when the next character is printed",
+          "[terminal]") {
+  Terminal terminal(3, 4);
+  feed(terminal, "abcd");
+  REQUIRE(terminal.cursorY() == 0);
+  REQUIRE(terminal.cursorX() == 3);
+  feed(terminal, "e");
+  REQUIRE(rowText(terminal, 0) == "abcd");
+  REQUIRE(rowText(terminal, 1) == "e   ");
+}
+
+TEST_CASE("output past the last row scrolls the screen up", "[terminal]") {
+  Terminal terminal(2, 3);
+  feed(terminal, "one\r\ntwo\r\nsix");
+  REQUIRE(rowText(terminal, 0) == "two");
+  REQUIRE(rowText(terminal, 1) == "six");
+}
+
+TEST_CASE("cursor movement and erase sequences", "[terminal]") {
+  Terminal terminal(3, 5);
+  feed(terminal, "aaaaa\r\nbbbbb\r\nccccc");
+  feed(terminal, "\x1b[2;3H\x1b[K");
+  REQUIRE(rowText(terminal, 1) == "bb   ");
+  feed(terminal, "\x1b[1J");
+  REQUIRE(rowText(terminal, 0) == "     ");
+  REQUIRE(rowText(terminal, 1) == "     ");
+  REQUIRE(rowText(terminal, 2) == "ccccc");
+  feed(terminal, "\x1b[H\x1b[2J");
+  REQUIRE(rowText(terminal, 2) == "     ");
+  REQUIRE(terminal.cursorY() == 0);
+  REQUIRE(terminal.cursorX() == 0);
+}
+
+TEST_CASE("sequences split between reads are still recognised",
+          "[terminal]") {
+  Terminal terminal(2, 10);
+  feed(terminal, "\x1b[");
+  feed(terminal, "3");
+  feed(terminal, "1mred\x1b");
+  feed(terminal, "[0m.");
+  REQUIRE(rowText(terminal, 0).substr(0, 4) == "red.");
+  REQUIRE(terminal.cell(0, 0).fg == COLOR_RED);
+  REQUIRE(terminal.cell(0, 3).fg == -1);
+}
+
+TEST_CASE("select graphic rendition sets colours and attributes",
+          "[terminal]") {
+  Terminal terminal(1, 10);
+  feed(terminal, "\x1b[1;44ma\x1b[22;92mb\x1b[38;5;196;48;2;0;255;0mc");
+  REQUIRE(terminal.cell(0, 0).attrs & CELL_BOLD);
+  REQUIRE(terminal.cell(0, 0).bg == COLOR_BLUE);
+  REQUIRE_FALSE(terminal.cell(0, 1).attrs & CELL_BOLD);
+  REQUIRE(terminal.cell(0, 1).attrs & CELL_BRIGHT);
+  REQUIRE(terminal.cell(0, 1).fg == COLOR_GREEN);
+  REQUIRE(terminal.cell(0, 2).fg == COLOR_RED);
+  REQUIRE(terminal.cell(0, 2).bg == COLOR_GREEN);
+}
+
+TEST_CASE("the alternate screen leaves the main screen untouched",
+          "[terminal]") {
+  Terminal terminal(2, 4);
+  feed(terminal, "main");
+  feed(terminal, "\x1b[?1049h\x1b[Halt");
+  REQUIRE(terminal.altScreen());
+  REQUIRE(rowText(terminal, 0) == "alt ");
+  feed(terminal, "\x1b[?1049l");
+  REQUIRE_FALSE(terminal.altScreen());
+  REQUIRE(rowText(terminal, 0) == "main");
+}
+
+TEST_CASE("a full reset leaves the alternate screen", "[terminal]") {
+  Terminal terminal(2, 4);
+  feed(terminal, "main\x1b[?1049h\x1b[2;3H\x1b" "7alt\x1b" "c");
+  REQUIRE_FALSE(terminal.altScreen());
+  REQUIRE(rowText(terminal, 0) == "    ");
+  REQUIRE(terminal.cursorY() == 0);
+  REQUIRE(terminal.cursorX() == 0);
+  feed(terminal, "\x1b" "8x");
+  REQUIRE(rowText(terminal, 0) == "x   ");
+}
+
+TEST_CASE("status requests are answered", "[terminal]") {
+  Terminal terminal(5, 10);
+  feed(terminal, "\x1b[3;4H\x1b[6n\x1b[c");
+  REQUIRE(terminal.takeResponse() == "\x1b[3;4R\x1b[?1;2c");
+  REQUIRE(terminal.takeResponse().empty());
+}
+
+TEST_CASE("operating system commands are skipped", "[terminal]") {
+  Terminal terminal(1, 10);
+  feed(terminal, "\x1b]0;window title\x07ok\x1b]2;x\x1b\\!");
+  REQUIRE(rowText(terminal, 0).substr(0, 3) == "ok!");
+}
+
+TEST_CASE("lines without escape sequences are a single run", "[ansi]") {
+  ColourPairs pairs;
+  AnsiText text(pairs);
+  std::vector<TextRun> runs;
+  text.runs("plain text", runs);
+  REQUIRE(runs.size() == 1);
+  REQUIRE(runs[0].begin == 0);
+  REQUIRE(runs[0].len == 10);
+  REQUIRE(runs[0].style == A_NORMAL);
+}
+
+TEST_CASE("SGR sequences split a line into styled runs", "[ansi]") {
+  ColourPairs pairs;
+  AnsiText text(pairs);
+  std::vector<TextRun> runs;
+  std::string const line = "a \x1b[1mbold\x1b[0m\x1b[K end";
+  text.runs(line, runs);
+  REQUIRE(runs.size() == 3);
+  REQUIRE(line.substr(runs[1].begin, runs[1].len) == "bold");
+  REQUIRE(runs[1].style & A_BOLD);
+  REQUIRE(line.substr(runs[2].begin, runs[2].len) == " end");
+  REQUIRE(runs[2].style == A_NORMAL);
+}
+
+TEST_CASE("the pen carries over to the next line", "[ansi]") {
+  ColourPairs pairs;
+  AnsiText text(pairs);
+  std::vector<TextRun> runs;
+  text.runs("\x1b[4mstart", runs);
+  text.runs("continued", runs);
+  REQUIRE(runs[0].style & A_UNDERLINE);
+  text.reset();
+  text.runs("continued", runs);
+  REQUIRE(runs[0].style == A_NORMAL);
+}
+
+TEST_CASE("strip removes every escape sequence", "[ansi]") {
+  REQUIRE(AnsiText::strip("\x1b[01;34mdir\x1b[0m/\x1b]8;;file\x07x") ==
+          "dir/x");
+  REQUIRE(AnsiText::strip("no escapes") == "no escapes");
+}
+
+int main(int argc, char const *argv[]) {
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,93 @@
+#ifndef DISPLAY_KERNEL_ANSI_TEXT_H
+#define DISPLAY_KERNEL_ANSI_TEXT_H
+
+/**
+ * AnsiText
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "ColourPairs.h"
+#include "Window.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace BlackOS {
+namespace DisplayKernel {
+
+enum CellAttribute : uint8_t {
+  CELL_BOLD = 1 << 0,
+  CELL_DIM = 1 << 1,
+  CELL_UNDERLINE = 1 << 2,
+  CELL_REVERSE = 1 << 3,
+  CELL_BLINK = 1 << 4,
+  CELL_INVISIBLE = 1 << 5,
+  CELL_BRIGHT = 1 << 6, // bright foreground, drawn bold
+};
+
+/// one character cell of a Terminal grid, also used as the pen text is
+/// written with. colours are curses colour numbers 0-7, or -1 for the
+/// default colour.
+struct Cell {
+  char ch = ' ';
+  int8_t fg = -1;
+  int8_t bg = -1;
+  uint8_t attrs = 0;
+};
+
+void applySgr(Cell &pen, int const *params, size_t const n);
+attr_t cellAttributes(uint8_t const attrs);
+
+/// a span of a line drawn with one style.
+struct TextRun {
+  size_t begin;
+  size_t len;
+  attr_t style;
+};
+
+/// converts text containing ANSI escape sequences, such as the output of
+/// `ls --color` or compiler diagnostics, into runs of curses attributes.
+/// colour and attribute (SGR) sequences change the pen, which carries over
+/// from one line to the next as it would on a terminal; every other escape
+/// sequence is dropped.
+class AnsiText {
+public:
+  explicit AnsiText(ColourPairs &pairs);
+
+  void runs(std::string const &line, std::vector<TextRun> &out);
+  void write(Window &window, std::string const &line);
+  void reset();
+
+  static std::string strip(std::string const &line);
+
+private:
+  size_t _skipEscape(std::string const &line, size_t pos);
+  attr_t _style();
+
+  ColourPairs &_pairs;
+  Cell _pen;
+  bool _styleValid = false;
+  attr_t _penStyle = A_NORMAL;
+  std::vector<int> _params;
+  std::vector<TextRun> _runs;
+};
+} // namespace DisplayKernel
+} // namespace BlackOS
+#endif
@@ -0,0 +1,52 @@
+#ifndef DISPLAY_KERNEL_COLOUR_PAIRS_H
+#define DISPLAY_KERNEL_COLOUR_PAIRS_H
+
+/**
+ * ColourPairs
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "ncurses.h"
+#include <vector>
+
+namespace BlackOS {
+namespace DisplayKernel {
+
+/// hands out curses colour pairs for foreground/background combinations on
+/// demand, initialising each pair the first time it is asked for. colours are
+/// the eight curses colours, or -1 for the default colour set with
+/// setDefault. pairs below firstPair are left for the caller's own use.
+class ColourPairs {
+public:
+  explicit ColourPairs(short const firstPair = 4);
+
+  void setDefault(int const fg, int const bg);
+  short pair(int fg, int bg);
+  void reset();
+
+private:
+  short _firstPair;
+  short _nextPair;
+  int _defaultFg = -1;
+  int _defaultBg = -1;
+  std::vector<short> _pairs; // indexed by (fg + 1) * 9 + (bg + 1)
+};
+} // namespace DisplayKernel
+} // namespace BlackOS
+#endif
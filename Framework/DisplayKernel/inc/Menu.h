@@ -26,6 +26,7 @@
 #include "DisplayObject.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -74,6 +75,7 @@ public:
   void eraseWin();
   void refresh();
   void setKeypad(bool);
+  void setInputTimeout(int const ms);
   void print(std::string const &str, attr_t style = A_NORMAL);
   void print(std::string const &format, std::string const &str,
              attr_t style = A_NORMAL);
@@ -84,6 +86,10 @@ public:
                std::vector<size_t> const &ignoreBlocks = {});
 
   void initFields(std::vector<std::string> const &fields);
+  void initFields(size_t const count,
+                  std::function<std::string(size_t)> const &field,
+                  size_t const width);
+  void showField(size_t const idx);
   void loadFields();
   std::string selectedField() const;
   size_t selectedFieldIndex() const;
@@ -124,6 +130,7 @@ private:
   size_t _winPosY;
   size_t _winPosX;
   std::vector<std::string> _fields;
+  std::function<std::string(size_t)> _fieldSource; // fields made on demand
   size_t _page;    // current partition to load
   size_t _fieldSz; // total number of Fields
   size_t _entriesPerPage = 0;
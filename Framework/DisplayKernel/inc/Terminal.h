@@ -0,0 +1,112 @@
+#ifndef DISPLAY_KERNEL_TERMINAL_H
+#define DISPLAY_KERNEL_TERMINAL_H
+
+/**
+ * Terminal
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "AnsiText.h"
+#include "ColourPairs.h"
+#include "Window.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace BlackOS {
+namespace DisplayKernel {
+
+/// a VT100/xterm screen: a state machine that consumes the bytes a program
+/// writes to its terminal and keeps the resulting character grid, which can
+/// then be drawn into a Window. only the rows that changed are redrawn.
+class Terminal {
+public:
+  Terminal(size_t const rows, size_t const cols);
+
+  void feed(char const *data, size_t const len);
+  void render(Window &window, ColourPairs &pairs);
+  void detach(Window &window);
+  void setCursor(size_t const y, size_t const x);
+  std::string takeResponse();
+
+  Cell const &cell(size_t const y, size_t const x) const;
+  size_t rows() const;
+  size_t cols() const;
+  size_t cursorY() const;
+  size_t cursorX() const;
+  bool cursorVisible() const;
+  bool altScreen() const;
+
+private:
+  enum class State { GROUND, ESCAPE, ESCAPE_INTERMEDIATE, CSI, STRING };
+
+  void _print(char const *run, size_t len);
+  void _control(char const c);
+  void _escape(char const c);
+  void _csi(char const c);
+  void _csiDispatch(char const final);
+  void _setMode(bool const set);
+  void _sgr();
+  void _lineFeed();
+  void _reverseIndex();
+  void _scrollUp(size_t const top, size_t const bottom, size_t n);
+  void _scrollDown(size_t const top, size_t const bottom, size_t n);
+  void _eraseCells(size_t const y, size_t const x1, size_t const x2);
+  void _switchScreen(bool const alt);
+  void _moveCursor(long y, long x);
+  void _markDirty(size_t const y1, size_t const y2);
+  int _param(size_t const idx, int const fallback) const;
+  Cell _blank() const;
+  Cell *_row(size_t const y);
+
+  size_t _rows;
+  size_t _cols;
+  std::vector<Cell> _grid;
+  std::vector<Cell> _otherGrid; // main grid while the alt screen is shown
+  std::vector<uint8_t> _dirty;   // row must be redrawn
+  std::vector<uint8_t> _touched; // row has been written by the program
+  std::vector<uint8_t> _otherTouched;
+
+  State _state = State::GROUND;
+  std::vector<int> _params;
+  char _private = 0;
+  std::string _response;
+
+  Cell _pen;
+  size_t _cursorY = 0;
+  size_t _cursorX = 0;
+  size_t _savedY = 0;
+  size_t _savedX = 0;
+  Cell _savedPen;
+  size_t _scrollTop = 0;
+  size_t _scrollBottom;
+  bool _wrapPending = false;
+  bool _autoWrap = true;
+  bool _cursorVisible = true;
+  bool _altScreen = false;
+  bool _altEntered = false;  // since the last render
+  bool _altLeft = false;     // since the last render
+  bool _renderedAlt = false; // the window shows the alt screen
+  size_t _pendingScroll = 0; // whole-window scrolls not yet drawn
+  size_t _scrollBeforeSave = 0;
+};
+} // namespace DisplayKernel
+} // namespace BlackOS
+#endif
@@ -79,6 +79,7 @@ public:
   void clear();
   void eraseWin();
   void refresh();
+  void touch();
   wchar_t getCharFromUser() const;
   int resize(size_t const y, size_t const x);
   int reposition(size_t const y, size_t const x);
@@ -86,12 +87,19 @@ public:
   void bgfg(int const fg, int const bg); // TODO: rename
   void setScroll(bool);
   void setKeypad(bool);
+  void setInputTimeout(int const ms);
 
   void newLine(bool newlineAtBeginning = true);
   void newLines(int n, bool newlineAtBeginning = true);
   void print(std::string const &str, attr_t style = A_NORMAL);
   void print(std::string const &format, std::string const &str,
              attr_t style = A_NORMAL);
+  void write(std::string const &str, attr_t style = A_NORMAL);
+  void write(char const *str, size_t const len, attr_t style = A_NORMAL);
+  void putCells(size_t const y, std::vector<chtype> const &cells);
+  void scrollLines(int const n);
+  void save();
+  void restore();
   std::vector<std::string> splitString(std::string, std::string const &);
   std::vector<std::string> splitString(std::string, char const);
   void printLines(std::string const &str, bool newlineAtBeginning = true);
@@ -103,6 +111,7 @@ public:
 
 private:
   WINDOW *_win = nullptr;
+  WINDOW *_saved = nullptr;
   size_t _winSzY;
   size_t _winSzX;
   size_t _winPosY;
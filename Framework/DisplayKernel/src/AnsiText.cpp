@@ -0,0 +1,270 @@
+/**
+ * AnsiText
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../inc/AnsiText.h"
+
+#include <cstring>
+
+namespace {
+
+/// returns the position just past the escape sequence starting at pos, which
+/// must hold an ESC byte. if the sequence is an SGR sequence its parameters
+/// are stored in params and sgr is set.
+size_t escapeEnd(std::string const &line, size_t pos, std::vector<int> &params,
+                 bool &sgr) {
+  sgr = false;
+  size_t const n = line.size();
+  if (++pos >= n)
+    return n;
+
+  char const kind = line[pos++];
+  if (kind == '[') {
+    params.clear();
+    bool privateMarker = false;
+    for (; pos < n; ++pos) {
+      char const c = line[pos];
+      if (c >= '0' && c <= '9') {
+        if (params.empty())
+          params.push_back(0);
+        int &param = params.back();
+        if (param < 10000)
+          param = param * 10 + (c - '0');
+      } else if (c == ';' || c == ':') {
+        if (params.empty())
+          params.push_back(0);
+        if (params.size() < 32)
+          params.push_back(0);
+      } else if (c >= '<' && c <= '?') {
+        privateMarker = true;
+      } else if (c >= 0x40 && c <= 0x7e) {
+        sgr = c == 'm' && !privateMarker;
+        return pos + 1;
+      }
+    }
+    return n;
+  }
+  if (kind == ']' || kind == 'P' || kind == 'X' || kind == '^' ||
+      kind == '_') {
+    // string sequences end with BEL or ST (ESC \).
+    for (; pos < n; ++pos) {
+      if (line[pos] == 0x07)
+        return pos + 1;
+      if (line[pos] == 0x1b && pos + 1 < n && line[pos + 1] == '\\')
+        return pos + 2;
+    }
+    return n;
+  }
+  if (kind == '(' || kind == ')' || kind == '*' || kind == '+' ||
+      kind == '#' || kind == '%' || kind == ' ')
+    return std::min(pos + 1, n);
+  return pos;
+}
+
+} // namespace
+
+namespace BlackOS {
+namespace DisplayKernel {
+
+/// apply the n parameters of a select graphic rendition (ESC [ ... m)
+/// sequence to pen. extended colours are reduced to the eight curses colours.
+void applySgr(Cell &pen, int const *params, size_t const n) {
+  if (n == 0) {
+    pen = Cell();
+    return;
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    int const p = params[i];
+    if (p == 0) {
+      pen = Cell();
+    } else if (p == 1) {
+      pen.attrs |= CELL_BOLD;
+    } else if (p == 2) {
+      pen.attrs |= CELL_DIM;
+    } else if (p == 4) {
+      pen.attrs |= CELL_UNDERLINE;
+    } else if (p == 5 || p == 6) {
+      pen.attrs |= CELL_BLINK;
+    } else if (p == 7) {
+      pen.attrs |= CELL_REVERSE;
+    } else if (p == 8) {
+      pen.attrs |= CELL_INVISIBLE;
+    } else if (p == 22) {
+      pen.attrs &= ~(CELL_BOLD | CELL_DIM);
+    } else if (p == 24) {
+      pen.attrs &= ~CELL_UNDERLINE;
+    } else if (p == 25) {
+      pen.attrs &= ~CELL_BLINK;
+    } else if (p == 27) {
+      pen.attrs &= ~CELL_REVERSE;
+    } else if (p == 28) {
+      pen.attrs &= ~CELL_INVISIBLE;
+    } else if (p >= 30 && p <= 37) {
+      pen.fg = p - 30;
+      pen.attrs &= ~CELL_BRIGHT;
+    } else if (p == 39) {
+      pen.fg = -1;
+      pen.attrs &= ~CELL_BRIGHT;
+    } else if (p >= 40 && p <= 47) {
+      pen.bg = p - 40;
+    } else if (p == 49) {
+      pen.bg = -1;
+    } else if (p >= 90 && p <= 97) {
+      pen.fg = p - 90;
+      pen.attrs |= CELL_BRIGHT;
+    } else if (p >= 100 && p <= 107) {
+      pen.bg = p - 100;
+    } else if (p == 38 || p == 48) {
+      // extended colours, reduced to the eight curses colours.
+      int colour = -1;
+      bool bright = false;
+      if (i + 2 < n && params[i + 1] == 5) {
+        int const idx = params[i + 2];
+        if (idx < 8) {
+          colour = idx;
+        } else if (idx < 16) {
+          colour = idx - 8;
+          bright = true;
+        } else if (idx < 232) {
+          int const c = idx - 16;
+          colour = (c / 36 >= 3) | ((c / 6 % 6 >= 3) << 1) | ((c % 6 >= 3) << 2);
+        } else {
+          colour = idx < 244 ? COLOR_BLACK : COLOR_WHITE;
+        }
+        i += 2;
+      } else if (i + 4 < n && params[i + 1] == 2) {
+        colour = (params[i + 2] >= 128) | ((params[i + 3] >= 128) << 1) |
+                 ((params[i + 4] >= 128) << 2);
+        i += 4;
+      } else {
+        break;
+      }
+      if (p == 38) {
+        pen.fg = colour;
+        if (bright)
+          pen.attrs |= CELL_BRIGHT;
+        else
+          pen.attrs &= ~CELL_BRIGHT;
+      } else {
+        pen.bg = colour;
+      }
+    }
+  }
+}
+
+/// curses attributes for a set of CellAttribute flags.
+attr_t cellAttributes(uint8_t const attrs) {
+  attr_t style = A_NORMAL;
+  if (attrs & (CELL_BOLD | CELL_BRIGHT))
+    style |= A_BOLD;
+  if (attrs & CELL_DIM)
+    style |= A_DIM;
+  if (attrs & CELL_UNDERLINE)
+    style |= A_UNDERLINE;
+  if (attrs & CELL_REVERSE)
+    style |= A_REVERSE;
+  if (attrs & CELL_BLINK)
+    style |= A_BLINK;
+  if (attrs & CELL_INVISIBLE)
+    style |= A_INVIS;
+  return style;
+}
+
+AnsiText::AnsiText(ColourPairs &pairs) : _pairs(pairs) {}
+
+/// forget the pen, e.g. before the output of a new command.
+void AnsiText::reset() {
+  _pen = Cell();
+  _styleValid = false;
+}
+
+/// split line into runs of text with their style, leaving out escape
+/// sequences. a line without an ESC byte is a single run.
+void AnsiText::runs(std::string const &line, std::vector<TextRun> &out) {
+  out.clear();
+  char const *data = line.data();
+  size_t const n = line.size();
+  size_t pos = 0;
+  while (pos < n) {
+    auto const *esc =
+        static_cast<char const *>(memchr(data + pos, 0x1b, n - pos));
+    size_t const stop = esc == nullptr ? n : esc - data;
+    if (stop > pos)
+      out.push_back({pos, stop - pos, _style()});
+    if (esc == nullptr)
+      break;
+    pos = _skipEscape(line, stop);
+  }
+}
+
+/// write line at the cursor of window in its colours. no refresh.
+void AnsiText::write(Window &window, std::string const &line) {
+  runs(line, _runs);
+  for (auto const &run : _runs)
+    window.write(line.data() + run.begin, run.len, run.style);
+}
+
+/// line with every escape sequence removed, for places that cannot draw
+/// attributes.
+std::string AnsiText::strip(std::string const &line) {
+  if (memchr(line.data(), 0x1b, line.size()) == nullptr)
+    return line;
+
+  std::string text;
+  std::vector<int> params;
+  bool sgr;
+  size_t pos = 0;
+  while (pos < line.size()) {
+    size_t const esc = line.find('\x1b', pos);
+    if (esc == std::string::npos) {
+      text.append(line, pos, std::string::npos);
+      break;
+    }
+    text.append(line, pos, esc - pos);
+    pos = escapeEnd(line, esc, params, sgr);
+  }
+  return text;
+}
+
+size_t AnsiText::_skipEscape(std::string const &line, size_t const pos) {
+  bool sgr;
+  size_t const end = escapeEnd(line, pos, _params, sgr);
+  if (sgr) {
+    applySgr(_pen, _params.data(), _params.size());
+    _styleValid = false;
+  }
+  return end;
+}
+
+/// curses style of the pen. text in the default colours takes no colour
+/// pair, so it is drawn in the window's own colours.
+attr_t AnsiText::_style() {
+  if (!_styleValid) {
+    _penStyle = cellAttributes(_pen.attrs);
+    if (_pen.fg >= 0 || _pen.bg >= 0)
+      _penStyle |= COLOR_PAIR(_pairs.pair(_pen.fg, _pen.bg));
+    _styleValid = true;
+  }
+  return _penStyle;
+}
+
+} // namespace DisplayKernel
+} // namespace BlackOS
@@ -0,0 +1,69 @@
+/**
+ * ColourPairs
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../inc/ColourPairs.h"
+
+namespace BlackOS {
+namespace DisplayKernel {
+
+ColourPairs::ColourPairs(short const firstPair)
+    : _firstPair(firstPair), _nextPair(firstPair), _pairs(9 * 9, -1) {}
+
+/// colours used where a caller asks for -1. pairs made with the old
+/// defaults are forgotten.
+void ColourPairs::setDefault(int const fg, int const bg) {
+  if (fg == _defaultFg && bg == _defaultBg)
+    return;
+  reset();
+  _defaultFg = fg;
+  _defaultBg = bg;
+}
+
+/// returns the pair number for fg on bg, or 0 if colour is unavailable or
+/// every pair that fits in a chtype is taken.
+short ColourPairs::pair(int fg, int bg) {
+  if (!has_colors())
+    return 0;
+  if (fg < 0 || fg > 7)
+    fg = _defaultFg;
+  if (bg < 0 || bg > 7)
+    bg = _defaultBg;
+
+  short &slot = _pairs[(fg + 1) * 9 + (bg + 1)];
+  if (slot >= 0)
+    return slot;
+
+  // COLOR_PAIR() keeps the pair number in eight bits of a chtype.
+  if (_nextPair >= COLOR_PAIRS || _nextPair > 255)
+    return 0;
+  init_pair(_nextPair, fg, bg);
+  slot = _nextPair++;
+  return slot;
+}
+
+/// forget every pair handed out, e.g. after the terminal colours changed.
+void ColourPairs::reset() {
+  _pairs.assign(_pairs.size(), -1);
+  _nextPair = _firstPair;
+}
+
+} // namespace DisplayKernel
+} // namespace BlackOS
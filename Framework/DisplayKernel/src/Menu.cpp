@@ -88,7 +88,7 @@ std::string Menu::winType() const { return "Menu"; }
 /// ACCESSOR
 std::string Menu::selectedField() const {
   size_t map = _highlightedMap();
-  return this->_fields[map];
+  return _fieldSource ? _fieldSource(map) : this->_fields[map];
 }
 
 std::vector<int> Menu::cursorPosition() const {
@@ -168,6 +168,7 @@ void Menu::_updateF() {
 void Menu::initFields(std::vector<std::string> const &fields) {
   _fields = fields;
   _fieldSz = fields.size();
+  _fieldSource = nullptr;
 
   // load defaults on new std::strings
   _page = 0;
@@ -176,6 +177,30 @@ void Menu::initFields(std::vector<std::string> const &fields) {
   _updateF();
 }
 
+/// MUTATOR RETROACTIVE
+/// count fields, made by field(i) only when their page is shown. every field
+/// is padded to width.
+void Menu::initFields(size_t const count,
+                      std::function<std::string(size_t)> const &field,
+                      size_t const width) {
+  _fields.clear();
+  _fieldSz = count;
+  _fieldSource = field;
+  _m = width;
+
+  _page = 0;
+  _updateF();
+}
+
+/// turn to the page of field idx and highlight it.
+void Menu::showField(size_t const idx) {
+  if (idx >= _fieldSz)
+    return;
+  _page = idx / _pCoeff();
+  _updateF();
+  _highlighted = idx % _pCoeff();
+}
+
 int Menu::lastKeyPressed() const { return _lastKeyPressed; }
 
 void Menu::_checkRange(size_t const y1, size_t const x1, size_t const y2,
@@ -661,6 +686,10 @@ void Menu::moveCursor(int y, int x) {
 
 void Menu::setKeypad(bool x) { keypad(_win, x); }
 
+/// how long getCharFromUser waits for a key before returning ERR: 0 not at
+/// all, a negative value for ever.
+void Menu::setInputTimeout(int const ms) { wtimeout(_win, ms); }
+
 void Menu::resetHighlighted() { _highlighted = 0; }
 
 void Menu::backPage() {
@@ -744,6 +773,13 @@ std::vector<std::string> Menu::_loadPage() {
 
   if (_fieldSz == 0)
     throw std::runtime_error("No fields were set.");
+  if (_fieldSource) {
+    std::vector<std::string> subFields;
+    size_t const first = _pCoeff() * _page;
+    for (size_t i = first; i < first + _f; ++i)
+      subFields.push_back(_fieldSource(i));
+    return subFields;
+  }
   if (numPages() == 1)
     return _fields;
 
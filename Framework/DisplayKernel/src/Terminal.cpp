@@ -0,0 +1,628 @@
+/**
+ * Terminal
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../inc/Terminal.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/// length of the run of bytes at the start of data that are drawn as they
+/// are, i.e. everything up to the first C0 control byte or DEL.
+size_t printableRun(char const *data, size_t const len) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  __m128i const controlMax = _mm_set1_epi8(0x1f);
+  __m128i const del = _mm_set1_epi8(0x7f);
+  for (; i + 16 <= len; i += 16) {
+    __m128i const v =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + i));
+    // unsigned v <= 0x1f  <=>  min(v, 0x1f) == v
+    __m128i const control = _mm_cmpeq_epi8(_mm_min_epu8(v, controlMax), v);
+    __m128i const stop = _mm_or_si128(control, _mm_cmpeq_epi8(v, del));
+    int const mask = _mm_movemask_epi8(stop);
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+#endif
+  for (; i < len; ++i) {
+    unsigned char const c = data[i];
+    if (c < 0x20 || c == 0x7f)
+      break;
+  }
+  return i;
+}
+
+} // namespace
+
+namespace BlackOS {
+namespace DisplayKernel {
+
+Terminal::Terminal(size_t const rows, size_t const cols)
+    : _rows(rows > 0 ? rows : 1), _cols(cols > 0 ? cols : 1),
+      _grid(_rows * _cols), _otherGrid(_rows * _cols), _dirty(_rows, 0),
+      _touched(_rows, 0), _otherTouched(_rows, 0), _scrollBottom(_rows - 1) {}
+
+size_t Terminal::rows() const { return _rows; }
+
+size_t Terminal::cols() const { return _cols; }
+
+size_t Terminal::cursorY() const { return _cursorY; }
+
+size_t Terminal::cursorX() const { return _cursorX; }
+
+bool Terminal::cursorVisible() const { return _cursorVisible; }
+
+bool Terminal::altScreen() const { return _altScreen; }
+
+Cell const &Terminal::cell(size_t const y, size_t const x) const {
+  return _grid[y * _cols + x];
+}
+
+Cell *Terminal::_row(size_t const y) { return &_grid[y * _cols]; }
+
+/// place the cursor, e.g. on the row below the shell prompt, before the
+/// program starts writing.
+void Terminal::setCursor(size_t const y, size_t const x) {
+  _moveCursor(y, x);
+}
+
+/// bytes the program asked the terminal to answer with (cursor position and
+/// device attribute reports). these should be written back to the program.
+std::string Terminal::takeResponse() {
+  std::string response;
+  response.swap(_response);
+  return response;
+}
+
+void Terminal::feed(char const *data, size_t const len) {
+  size_t i = 0;
+  while (i < len) {
+    if (_state == State::GROUND) {
+      size_t const run = printableRun(data + i, len - i);
+      if (run > 0) {
+        _print(data + i, run);
+        i += run;
+        continue;
+      }
+      _control(data[i++]);
+      continue;
+    }
+
+    char const c = data[i++];
+    switch (_state) {
+    case State::ESCAPE:
+      _escape(c);
+      break;
+    case State::ESCAPE_INTERMEDIATE:
+      // character set designations and the like take one more byte.
+      _state = State::GROUND;
+      break;
+    case State::CSI:
+      _csi(c);
+      break;
+    case State::STRING:
+      // OSC, DCS and friends end with BEL or ST (ESC \).
+      if (c == 0x07)
+        _state = State::GROUND;
+      else if (c == 0x1b)
+        _state = State::ESCAPE;
+      break;
+    default:
+      _state = State::GROUND;
+      break;
+    }
+  }
+}
+
+void Terminal::_print(char const *run, size_t len) {
+  while (len > 0) {
+    if (_wrapPending) {
+      // when autowrap is off the cursor stays on the last column.
+      if (_autoWrap) {
+        _cursorX = 0;
+        _lineFeed();
+      }
+      _wrapPending = false;
+    }
+
+    size_t const n = std::min(len, _cols - _cursorX);
+    Cell *row = _row(_cursorY) + _cursorX;
+    for (size_t i = 0; i < n; ++i) {
+      row[i] = _pen;
+      row[i].ch = run[i];
+    }
+    _markDirty(_cursorY, _cursorY);
+
+    _cursorX += n;
+    run += n;
+    len -= n;
+    if (_cursorX >= _cols) {
+      _cursorX = _cols - 1;
+      _wrapPending = true;
+    }
+  }
+}
+
+void Terminal::_control(char const c) {
+  switch (c) {
+  case 0x08: // BS
+    if (_cursorX > 0)
+      --_cursorX;
+    _wrapPending = false;
+    break;
+  case 0x09: // HT
+    _cursorX = std::min(_cols - 1, (_cursorX / 8 + 1) * 8);
+    _wrapPending = false;
+    break;
+  case 0x0a: // LF
+  case 0x0b: // VT
+  case 0x0c: // FF
+    _lineFeed();
+    break;
+  case 0x0d: // CR
+    _cursorX = 0;
+    _wrapPending = false;
+    break;
+  case 0x18: // CAN
+  case 0x1a: // SUB
+    _state = State::GROUND;
+    break;
+  case 0x1b: // ESC
+    _state = State::ESCAPE;
+    break;
+  default: // BEL, SO, SI and the rest are ignored
+    break;
+  }
+}
+
+void Terminal::_escape(char const c) {
+  _state = State::GROUND;
+  switch (c) {
+  case '[':
+    _params.clear();
+    _private = 0;
+    _state = State::CSI;
+    break;
+  case ']':
+  case 'P':
+  case 'X':
+  case '^':
+  case '_':
+    _state = State::STRING;
+    break;
+  case '(':
+  case ')':
+  case '*':
+  case '+':
+  case '#':
+  case '%':
+  case ' ':
+    _state = State::ESCAPE_INTERMEDIATE;
+    break;
+  case '7':
+    _savedY = _cursorY;
+    _savedX = _cursorX;
+    _savedPen = _pen;
+    break;
+  case '8':
+    _moveCursor(_savedY, _savedX);
+    _pen = _savedPen;
+    break;
+  case 'D':
+    _lineFeed();
+    break;
+  case 'E':
+    _cursorX = 0;
+    _lineFeed();
+    break;
+  case 'M':
+    _reverseIndex();
+    break;
+  case 'c':
+    // a full reset returns to the main screen and forgets the saved cursor.
+    _switchScreen(false);
+    _savedY = 0;
+    _savedX = 0;
+    _savedPen = Cell();
+    std::fill(_grid.begin(), _grid.end(), Cell());
+    _markDirty(0, _rows - 1);
+    _pen = Cell();
+    _scrollTop = 0;
+    _scrollBottom = _rows - 1;
+    _autoWrap = true;
+    _cursorVisible = true;
+    _moveCursor(0, 0);
+    break;
+  default:
+    break;
+  }
+}
+
+void Terminal::_csi(char const c) {
+  if (c >= '0' && c <= '9') {
+    if (_params.empty())
+      _params.push_back(0);
+    int &param = _params.back();
+    if (param < 10000)
+      param = param * 10 + (c - '0');
+  } else if (c == ';' || c == ':') {
+    if (_params.empty())
+      _params.push_back(0);
+    if (_params.size() < 32)
+      _params.push_back(0);
+  } else if (c >= '<' && c <= '?') {
+    _private = c;
+  } else if (c >= 0x40 && c <= 0x7e) {
+    _state = State::GROUND;
+    _csiDispatch(c);
+  } else if (c == 0x1b) {
+    _state = State::ESCAPE;
+  } else if (static_cast<unsigned char>(c) < 0x20) {
+    _control(c);
+  }
+  // intermediate bytes (0x20-0x2f) are ignored.
+}
+
+/// parameter idx, or fallback when it is missing or zero.
+int Terminal::_param(size_t const idx, int const fallback) const {
+  if (idx < _params.size() && _params[idx] != 0)
+    return _params[idx];
+  return fallback;
+}
+
+void Terminal::_csiDispatch(char const final) {
+  if (_private == '?') {
+    if (final == 'h' || final == 'l')
+      _setMode(final == 'h');
+    return;
+  }
+  if (_private == '>') {
+    if (final == 'c')
+      _response += "\x1b[>0;0;0c";
+    return;
+  }
+  if (_private != 0)
+    return;
+
+  long const y = _cursorY;
+  long const x = _cursorX;
+  int const n = _param(0, 1);
+  int const mode = _params.empty() ? 0 : _params[0];
+
+  switch (final) {
+  case '@': { // ICH
+    size_t const count = std::min<size_t>(n, _cols - _cursorX);
+    Cell *row = _row(_cursorY);
+    std::move_backward(row + _cursorX, row + _cols - count, row + _cols);
+    std::fill(row + _cursorX, row + _cursorX + count, _blank());
+    _markDirty(_cursorY, _cursorY);
+    break;
+  }
+  case 'A': // CUU
+    _moveCursor(y - n, x);
+    break;
+  case 'B': // CUD
+  case 'e':
+    _moveCursor(y + n, x);
+    break;
+  case 'C': // CUF
+  case 'a':
+    _moveCursor(y, x + n);
+    break;
+  case 'D': // CUB
+    _moveCursor(y, x - n);
+    break;
+  case 'E': // CNL
+    _moveCursor(y + n, 0);
+    break;
+  case 'F': // CPL
+    _moveCursor(y - n, 0);
+    break;
+  case 'G': // CHA
+  case '`':
+    _moveCursor(y, n - 1);
+    break;
+  case 'd': // VPA
+    _moveCursor(n - 1, x);
+    break;
+  case 'H': // CUP
+  case 'f':
+    _moveCursor(_param(0, 1) - 1, _param(1, 1) - 1);
+    break;
+  case 'J': // ED
+    if (mode == 0) {
+      _eraseCells(_cursorY, _cursorX, _cols - 1);
+      for (size_t row = _cursorY + 1; row < _rows; ++row)
+        _eraseCells(row, 0, _cols - 1);
+    } else if (mode == 1) {
+      for (size_t row = 0; row < _cursorY; ++row)
+        _eraseCells(row, 0, _cols - 1);
+      _eraseCells(_cursorY, 0, _cursorX);
+    } else {
+      for (size_t row = 0; row < _rows; ++row)
+        _eraseCells(row, 0, _cols - 1);
+    }
+    break;
+  case 'K': // EL
+    if (mode == 0)
+      _eraseCells(_cursorY, _cursorX, _cols - 1);
+    else if (mode == 1)
+      _eraseCells(_cursorY, 0, _cursorX);
+    else
+      _eraseCells(_cursorY, 0, _cols - 1);
+    break;
+  case 'L': // IL
+    if (_cursorY >= _scrollTop && _cursorY <= _scrollBottom)
+      _scrollDown(_cursorY, _scrollBottom, n);
+    break;
+  case 'M': // DL
+    if (_cursorY >= _scrollTop && _cursorY <= _scrollBottom)
+      _scrollUp(_cursorY, _scrollBottom, n);
+    break;
+  case 'P': { // DCH
+    size_t const count = std::min<size_t>(n, _cols - _cursorX);
+    Cell *row = _row(_cursorY);
+    std::move(row + _cursorX + count, row + _cols, row + _cursorX);
+    std::fill(row + _cols - count, row + _cols, _blank());
+    _markDirty(_cursorY, _cursorY);
+    break;
+  }
+  case 'X': // ECH
+    _eraseCells(_cursorY, _cursorX,
+                std::min<size_t>(_cursorX + n, _cols) - 1);
+    break;
+  case 'S': // SU
+    _scrollUp(_scrollTop, _scrollBottom, n);
+    break;
+  case 'T': // SD
+    _scrollDown(_scrollTop, _scrollBottom, n);
+    break;
+  case 'm':
+    _sgr();
+    break;
+  case 'r': { // DECSTBM
+    size_t const top = _param(0, 1) - 1;
+    size_t const bottom = _param(1, _rows) - 1;
+    if (top < bottom && bottom < _rows) {
+      _scrollTop = top;
+      _scrollBottom = bottom;
+      _moveCursor(0, 0);
+    }
+    break;
+  }
+  case 's':
+    _savedY = _cursorY;
+    _savedX = _cursorX;
+    break;
+  case 'u':
+    _moveCursor(_savedY, _savedX);
+    break;
+  case 'n': // DSR
+    if (mode == 5)
+      _response += "\x1b[0n";
+    else if (mode == 6)
+      _response += "\x1b[" + std::to_string(_cursorY + 1) + ";" +
+                   std::to_string(_cursorX + 1) + "R";
+    break;
+  case 'c': // DA
+    _response += "\x1b[?1;2c";
+    break;
+  default:
+    break;
+  }
+}
+
+void Terminal::_setMode(bool const set) {
+  for (int const mode : _params) {
+    switch (mode) {
+    case 7:
+      _autoWrap = set;
+      break;
+    case 25:
+      _cursorVisible = set;
+      break;
+    case 1049:
+      if (set) {
+        _savedY = _cursorY;
+        _savedX = _cursorX;
+        _switchScreen(true);
+      } else {
+        _switchScreen(false);
+        _moveCursor(_savedY, _savedX);
+      }
+      break;
+    case 47:
+    case 1047:
+      _switchScreen(set);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void Terminal::_sgr() { applySgr(_pen, _params.data(), _params.size()); }
+
+void Terminal::_lineFeed() {
+  _wrapPending = false;
+  if (_cursorY == _scrollBottom)
+    _scrollUp(_scrollTop, _scrollBottom, 1);
+  else if (_cursorY + 1 < _rows)
+    ++_cursorY;
+}
+
+void Terminal::_reverseIndex() {
+  _wrapPending = false;
+  if (_cursorY == _scrollTop)
+    _scrollDown(_scrollTop, _scrollBottom, 1);
+  else if (_cursorY > 0)
+    --_cursorY;
+}
+
+void Terminal::_scrollUp(size_t const top, size_t const bottom, size_t n) {
+  size_t const height = bottom - top + 1;
+  n = std::min(n, height);
+  Cell *base = _row(top);
+  std::move(base + n * _cols, base + height * _cols, base);
+  std::fill(base + (height - n) * _cols, base + height * _cols, _blank());
+
+  if (top == 0 && bottom == _rows - 1 && !_altScreen) {
+    // the window scrolls its own copy of the screen, so rows the program
+    // has not written (e.g. the shell's earlier output) move up with it.
+    std::move(_dirty.begin() + n, _dirty.end(), _dirty.begin());
+    std::move(_touched.begin() + n, _touched.end(), _touched.begin());
+    _pendingScroll += n;
+    _markDirty(_rows - n, _rows - 1);
+  } else {
+    _markDirty(top, bottom);
+  }
+}
+
+void Terminal::_scrollDown(size_t const top, size_t const bottom, size_t n) {
+  size_t const height = bottom - top + 1;
+  n = std::min(n, height);
+  Cell *base = _row(top);
+  std::move_backward(base, base + (height - n) * _cols, base + height * _cols);
+  std::fill(base, base + n * _cols, _blank());
+  _markDirty(top, bottom);
+}
+
+void Terminal::_eraseCells(size_t const y, size_t const x1, size_t const x2) {
+  if (x1 > x2 || x2 >= _cols)
+    return;
+  Cell *row = _row(y);
+  std::fill(row + x1, row + x2 + 1, _blank());
+  _markDirty(y, y);
+}
+
+void Terminal::_switchScreen(bool const alt) {
+  if (alt == _altScreen)
+    return;
+
+  if (alt) {
+    // scrolls of the main screen must reach the window before it is saved.
+    _scrollBeforeSave += _pendingScroll;
+    _pendingScroll = 0;
+    _altEntered = true;
+  } else {
+    _altLeft = true;
+  }
+
+  std::swap(_grid, _otherGrid);
+  std::swap(_touched, _otherTouched);
+  _altScreen = alt;
+  if (alt) {
+    std::fill(_grid.begin(), _grid.end(), Cell());
+    std::fill(_touched.begin(), _touched.end(), 1);
+  }
+  _dirty = _touched;
+}
+
+void Terminal::_moveCursor(long y, long x) {
+  y = std::max(0L, std::min<long>(y, _rows - 1));
+  x = std::max(0L, std::min<long>(x, _cols - 1));
+  _cursorY = y;
+  _cursorX = x;
+  _wrapPending = false;
+}
+
+void Terminal::_markDirty(size_t const y1, size_t const y2) {
+  for (size_t y = y1; y <= y2 && y < _rows; ++y) {
+    _dirty[y] = 1;
+    _touched[y] = 1;
+  }
+}
+
+/// an empty cell in the current background colour.
+Cell Terminal::_blank() const {
+  Cell blank;
+  blank.bg = _pen.bg;
+  return blank;
+}
+
+/// draw the rows that changed since the last render into window and place
+/// the window cursor on the terminal cursor.
+void Terminal::render(Window &window, ColourPairs &pairs) {
+  if (_altLeft && _renderedAlt)
+    window.restore();
+  if (_altEntered) {
+    if (_scrollBeforeSave > 0)
+      window.scrollLines(std::min(_scrollBeforeSave, _rows));
+    window.save();
+  }
+  if (_pendingScroll > 0)
+    window.scrollLines(std::min(_pendingScroll, _rows));
+  _altEntered = false;
+  _altLeft = false;
+  _scrollBeforeSave = 0;
+  _pendingScroll = 0;
+  _renderedAlt = _altScreen;
+
+  std::vector<chtype> line(_cols);
+  int lastFg = -2, lastBg = -2;
+  chtype colour = 0;
+  for (size_t y = 0; y < _rows; ++y) {
+    if (!_dirty[y])
+      continue;
+    Cell const *row = &_grid[y * _cols];
+    for (size_t x = 0; x < _cols; ++x) {
+      Cell const &c = row[x];
+      if (c.fg != lastFg || c.bg != lastBg) {
+        lastFg = c.fg;
+        lastBg = c.bg;
+        colour = COLOR_PAIR(pairs.pair(c.fg, c.bg));
+      }
+      line[x] = static_cast<unsigned char>(c.ch) | colour |
+                cellAttributes(c.attrs);
+    }
+    window.putCells(y, line);
+    _dirty[y] = 0;
+  }
+
+  window.moveCursor(_cursorY, _cursorX);
+  window.refresh();
+}
+
+/// give the window back, e.g. while the program is stopped. what the program
+/// drew on the main screen stays in the window as ordinary text; the alt
+/// screen is drawn again in full by the next render.
+void Terminal::detach(Window &window) {
+  if (_renderedAlt)
+    window.restore();
+  _renderedAlt = false;
+  _altLeft = false;
+  _altEntered = _altScreen;
+  _scrollBeforeSave = 0;
+  _pendingScroll = 0;
+  if (_altScreen) {
+    std::fill(_touched.begin(), _touched.end(), 1);
+    _dirty = _touched;
+  } else {
+    std::fill(_touched.begin(), _touched.end(), 0);
+    std::fill(_dirty.begin(), _dirty.end(), 0);
+  }
+}
+
+} // namespace DisplayKernel
+} // namespace BlackOS
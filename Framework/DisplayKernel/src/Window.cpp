@@ -358,6 +358,53 @@ void Window::print(std::string const &format, std::string const &str,
   wattroff(_win, style);
 }
 
+/// writes str at the cursor as-is: no format interpretation and no refresh,
+/// for text that did not come from this program such as command output.
+void Window::write(std::string const &str, attr_t style) {
+  write(str.data(), str.size(), style);
+}
+
+void Window::write(char const *str, size_t const len, attr_t style) {
+  wattron(_win, style);
+  waddnstr(_win, str, len);
+  wattroff(_win, style);
+}
+
+/// overwrites row y from column 0 with already attributed characters,
+/// without moving the cursor or refreshing.
+void Window::putCells(size_t const y, std::vector<chtype> const &cells) {
+  mvwaddchnstr(_win, y, 0, cells.data(), cells.size());
+}
+
+/// scrolls the window contents up by n rows (down if n is negative), also
+/// when scrolling is not enabled for the window.
+void Window::scrollLines(int const n) {
+  bool const scrolling = is_scrollok(_win);
+  scrollok(_win, TRUE);
+  wscrl(_win, n);
+  scrollok(_win, scrolling);
+}
+
+/// keeps a copy of the window contents for restore, e.g. while a program
+/// takes over the whole window.
+void Window::save() {
+  if (_saved != nullptr)
+    delwin(_saved);
+  _saved = dupwin(_win);
+}
+
+/// puts back the contents kept by save.
+void Window::restore() {
+  if (_saved == nullptr)
+    return;
+  int Y, X;
+  getmaxyx(_win, Y, X);
+  copywin(_saved, _win, 0, 0, 0, 0, Y - 1, X - 1, FALSE);
+  delwin(_saved);
+  _saved = nullptr;
+  touchwin(_win);
+}
+
 /// sets the title for the window with an optional style option (default none).
 /// This will not show the title to screen on window refresh if the the tite is
 /// hidden.
@@ -550,10 +597,18 @@ void Window::eraseExcept(std::vector<size_t> const &elements) {
 
 void Window::refresh() { wrefresh(_win); }
 
+/// marks the whole window as changed, so the next refresh redraws it over
+/// anything a window on top of it left behind.
+void Window::touch() { touchwin(_win); }
+
 void Window::setScroll(bool x) { scrollok(_win, x); }
 
 void Window::setKeypad(bool x) { keypad(_win, x); }
 
+/// how long getCharFromUser waits for a key before returning ERR: 0 not at
+/// all, a negative value for ever.
+void Window::setInputTimeout(int const ms) { wtimeout(_win, ms); }
+
 void Window::setWin(WIN_SET_CODE const init) {
 
   if (init == WIN_SET_CODE::INIT_PARENT) {
@@ -592,6 +647,8 @@ int Window::reposition(size_t const y, size_t const x) {
 }
 
 Window::~Window() {
+  if (_saved != nullptr)
+    delwin(_saved);
   // TODO: store init mode and kill correspondingly
   if (windowSet())
     setWin(WIN_SET_CODE::KILL_PARENT);
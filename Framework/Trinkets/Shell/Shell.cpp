@@ -23,18 +23,44 @@
 
 using namespace BlackOS::Trinkets;
 
-int main() {
+int main(int argc, char **argv) {
+  StartupProfiler startup;
+
+  bool showProfile = false;
+  bool fastStart = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string const option = argv[i];
+    if (option == "--startup-profile") {
+      showProfile = true;
+    } else if (option == "--fast-start") {
+      fastStart = true;
+    } else {
+      std::cout << "usage: Tr [--fast-start] [--startup-profile]" << std::endl;
+      return RESULT::BAD_USAGE;
+    }
+  }
 
   // use stdscreen
   auto display = generateSharedWindow();
   display->hideBorder();
+  startup.mark("start curses");
 
-  Shell shell;
-  shell.loadShell();
+  Shell shell(&startup);
+  startup.mark("construct shell");
+  shell.loadShell(fastStart);
 
+  bool firstPrompt = true;
   while (1) {
 
     shell.displayPrompt();
+    if (firstPrompt) {
+      firstPrompt = false;
+      startup.mark("first prompt");
+      if (showProfile) {
+        shell.showStartupProfile();
+        shell.displayPrompt();
+      }
+    }
 
     int result = shell.readArgs();
     auto const &argv = shell.argv();
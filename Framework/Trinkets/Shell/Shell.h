@@ -22,15 +22,32 @@
  * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
  */
 
-#include "../../External/inc/pstream.h"
+#include "../helpers/CommandCapture.h"
+#include "../helpers/CommandLexer.h"
+#include "../helpers/Completion.h"
+#include "../helpers/ConfigStore.h"
+#include "../helpers/DirectoryCache.h"
+#include "../helpers/DirectoryPrefetcher.h"
+#include "../helpers/DirectoryRank.h"
+#include "../helpers/HistoryStore.h"
+#include "../helpers/LineEditor.h"
+#include "../helpers/Job.h"
+#include "../helpers/OutputPipeline.h"
 #include "../helpers/PathController.h"
+#include "../helpers/PreviewCache.h"
+#include "../helpers/PtySession.h"
+#include "../helpers/StartupProfiler.h"
+#include "AnsiText.h"
+#include "ColourPairs.h"
 #include "Screen.h"
+#include "Terminal.h"
 #include "Window.h"
 
 #include <cctype>
 #include <cerrno>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <cstring>
 #include <deque>
 #include <fcntl.h>
@@ -39,12 +56,14 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <poll.h>
 #include <signal.h>
 #include <sstream>
 #include <stdexcept>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <string_view>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -105,12 +124,17 @@ class Shell {
 public:
   /// command type
   typedef int (Shell::*command)(void);
-  /// command map
-  typedef std::pair<std::string, command> pair;
-  /// command map
-  typedef std::map<std::string, command> command_map;
 
-  Shell();
+  /// an entry of the registry of built-in commands, config keys and themes.
+  struct Builtin {
+    std::string_view name;
+    command run;     // nullptr for programs the shell only knows about
+    uint8_t minArgs; // counting the command itself
+    uint8_t maxArgs;
+    bool captured; // output is captured rather than run on a terminal
+  };
+
+  explicit Shell(StartupProfiler *startup = nullptr);
 
   /// execute native commands
   int execute();
@@ -120,8 +144,13 @@ public:
   size_t cursorY();
   ///
   size_t cursorX();
-  /// load the shell
-  void loadShell();
+  /// load the shell. a fast start leaves out the splash screen and puts off
+  /// the bell and the list view until the first prompt is waiting for input.
+  void loadShell(bool const fastStart = false);
+  /// run the startup work put off by a fast start.
+  void finishStartup();
+  /// print the startup timeline
+  void showStartupProfile();
   /// Reads input from the user into the given array and returns the number of
   /// arguments taken in.
   int readArgs();
@@ -130,6 +159,9 @@ public:
   void runCommand();
   ///
   int initShellVariables();
+  void markStartup(char const *phase);
+  void reportConfigErrors();
+  void repaint();
   ///
   void resetArgs();
   ///
@@ -181,6 +213,14 @@ public:
   int listView();
   ///
   int listView(bool);
+  ///
+  int scrollback();
+  ///
+  int jobs();
+  ///
+  int foreground();
+  ///
+  int jump();
 
   /// configurations
 
@@ -218,6 +258,10 @@ public:
   int MOVE();
   ///
   int configListView();
+  ///
+  int configFrameRate();
+  ///
+  int configSortOrder();
 
   ~Shell();
 
@@ -227,10 +271,30 @@ private:
   std::vector<std::string> splitString(std::string, char const);
   ///
   void newLine(bool newlineAtBeginning = true);
+  ///
+  void renderOutput(std::deque<std::string> const &lines, size_t skipped);
+  ///
+  void foregroundJob(Job &job);
+  ///
+  int runInTerminal(Job &job);
+  ///
+  int runCaptured(Job &job);
+  ///
+  int runWithTerminal(Job &job);
+  ///
+  void useThemeColours();
+  ///
+  bool reverseSearch(std::string &line);
+  ///
+  void completeLine(std::string &line);
 
   // constants
   int const _MAX_ARGS = 1024;
-  int const _MAX_MEMORY_HISTORY = 50;
+  size_t const _MAX_MEMORY_HISTORY = 50; // commands listed by memory
+  size_t const _MAX_SCROLLBACK = 10000;
+  size_t const _MAX_COMPLETIONS = 1000; // listed in the completion menu
+  int const _LOADING_POLL_MS = 50; // between updates of a directory loading
+  int const _PREVIEW_DELAY_MS = 60; // the highlight rests before a preview
 
   // display object variables
   Window_sptr _DISPLAY;
@@ -244,6 +308,8 @@ private:
   struct termios _OLDT;
   struct termios _NEWT;
   bool _COLOUR_SUPPORT;
+  DisplayKernel::ColourPairs _COLOUR_PAIRS; // for colours in command output
+  DisplayKernel::AnsiText _ANSI_TEXT{_COLOUR_PAIRS};
   std::vector<size_t> _IGNORE_BLOCKS;
 
   // environment variables
@@ -260,6 +326,8 @@ private:
   int _STD_FG = standardColours::WHITE;
   std::string _CURSOR_COLOUR = "red";
   bool _SHOW_BORDER = 0;
+  int _FRAME_RATE = 30; // max redraws per second of captured output
+  SortOrder _SORT_ORDER = SortOrder::NAME; // of ls, nd and lsview
 
   // default system colours / styles
   int _STYLE_ERROR;
@@ -270,12 +338,23 @@ private:
   std::filesystem::path _CONFIG_FILE;
   std::filesystem::path _SHELL_ENV_FILE;
   std::filesystem::path _SHORTCUTS_FILE;
+  std::filesystem::path _CONFIG_CACHE_FILE;
   std::filesystem::path _HISTORY_FILE;
+  std::filesystem::path _DIRECTORY_RANK_FILE;
   std::string _LAST_COMMAND;
   std::string _TIME_OF_LAST_COMMAND;
   std::string _RESULT_OF_LAST_COMMAND;
   std::vector<std::string> _ARGV;
-  std::deque<std::string> _COMMAND_HISTORY;
+  CommandLexer _LEXER; // the last line read, split into tokens
+  HistoryStore _HISTORY;
+  DirectoryRank _DIRECTORY_RANK; // directories by frecency, for j and sc
+  ConfigStore _CONFIG; // config, environment and shortcut files
+  DirectoryCache _DIRECTORY_CACHE; // listings shared by ls, nd and lsview
+  Completer _COMPLETER{&_DIRECTORY_CACHE}; // completes paths from them
+  std::unique_ptr<DirectoryPrefetcher> _PREFETCHER; // reads ahead for both
+  PreviewCache _PREVIEW_CACHE;                      // of lsview
+  std::deque<std::string> _SCROLLBACK; // captured command output
+  std::vector<Job> _JOBS;              // stopped jobs, most recent last
   int _ARGC;
 
   // screen attributes
@@ -283,6 +362,11 @@ private:
   bool _LIST_VIEW_HIDDEN_ENABLED = 0;
   bool _TTY_FLAG_FALLBACK = 0;
   bool _USING_COLOR_FLAG = 0;
+  bool _DEFER_REPAINT = false;     // set while settings are being applied
+  bool _REPAINT_PENDING = false;   // a setting changed while deferred
+  bool _STARTUP_PENDING = false;   // fast start work still to be done
+  bool _LIST_VIEW_PENDING = false; // LSVIEW set during a fast start
+  StartupProfiler *_STARTUP = nullptr; // startup timeline, if kept
   std::filesystem::path _CURRENT_DIR; // or should we only get this on call?
 
   // subwindows
@@ -292,62 +376,30 @@ private:
   size_t _LSVIEW_SIZE_X;
   size_t _LSVIEW_POS_Y = 0;
   size_t _LSVIEW_POS_X;
+  bool _LSVIEW_PENDING = false;  // a preview waits for the highlight to rest
+  bool _LSVIEW_FETCHING = false; // and its directory is being read
+  std::filesystem::path _LSVIEW_PENDING_DIR;
+  std::chrono::steady_clock::time_point _LSVIEW_DUE;
 
   // user input variables
   struct sigaction _SIGNAL_INT_HANDLER;
+  struct sigaction _SIGNAL_TSTP_HANDLER;
+  struct sigaction _SIGNAL_CHLD_HANDLER;
   int _DELETE = -1; // delete custom keymap
 
   /// internal methods
   void displayListView(std::filesystem::path const &);
-
-  command_map _COMMAND_MAP{
-      pair("bell", &Shell::bell),
-      pair("cd", &Shell::changeDir),
-      pair("clear", &Shell::clearScreen),
-      pair("configure", &Shell::configure),
-      pair("config", &Shell::configure),
-      pair("ls", &Shell::listChildren),
-      pair("lsconfig", &Shell::listConfigVariables),
-      pair("nd", &Shell::navigateDir),
-      pair("ndir", &Shell::navigateDir),
-      pair("rainbow", &Shell::rainbow),
-      pair("sc", &Shell::shortcut),
-      pair("shortcut", &Shell::shortcut),
-      pair("memory", &Shell::printMemoryHistory),
-      pair("lsview", &Shell::listView),
-      pair("cpos", &Shell::cpos),
-      pair("move", &Shell::MOVE),
-  };
-
-  command_map _SHELL_CONFIG_MAP{
-      pair("BG", &Shell::configBackgroundColour),
-      pair("CURSOR", &Shell::configCursor),
-      pair("CURSCOL", &Shell::configCursorColour),
-      pair("DELETE", &Shell::configDeleteKey),
-      pair("FG", &Shell::configForegroundColour),
-      pair("THEME", &Shell::configTheme),
-      pair("LSVIEW", &Shell::configListView),
-  };
-
-  command_map _THEME_MAP{
-      pair("invader", &Shell::configThemeInvader),
-      pair("ire", &Shell::configThemeIre),
-      pair("neptune", &Shell::configThemeNeptune),
-      pair("classic", &Shell::configThemeClassic),
-      pair("anticlassic", &Shell::configThemeAntiClassic),
-      pair("thinkpad", &Shell::configThemeThinkPad),
-      pair("system", &Shell::configThemeSystem),
-      pair("ugly", &Shell::configThemeUgly),
-  };
-  std::vector<std::string> _PRINTABLES{
-      "make",
-      "ps",
-      "ss",
-      "nproc",
-      "lspci",
-      "dir",
-      "acpi",
-  };
+  void previewListView(std::filesystem::path const &);
+  int updateListView();
+  ListViewPreview const &listViewPreview(std::filesystem::path const &dir,
+                                         size_t const height);
+  DirectoryPrefetcher &directoryPrefetcher();
+
+  // the registry, looked up by perfect hash (Registry.cpp)
+  static Builtin const *findBuiltin(std::string_view const name);
+  static Builtin const *findConfigKey(std::string_view const name);
+  static Builtin const *findTheme(std::string_view const name);
+  static std::vector<std::string> builtinNames();
 };
 
 } // namespace Trinkets
@@ -29,6 +29,9 @@ int Shell::changeDir() {
     char const *homeDir = getenv("HOME");
     chdir(homeDir);
     _CURRENT_DIR = homeDir;
+    // ARGC is 0 when the shell starts in HOME, which is not a visit.
+    if (_ARGC == 1)
+      _DIRECTORY_RANK.visit(_CURRENT_DIR);
     // update LSVIEW if active
     if (_LIST_VIEW_ENABLED) {
       displayListView(_CURRENT_DIR);
@@ -43,6 +46,7 @@ int Shell::changeDir() {
     char buffer[_MAX_ARGS];
     getcwd(buffer, sizeof buffer);
     _CURRENT_DIR = buffer;
+    _DIRECTORY_RANK.visit(_CURRENT_DIR);
     // update LSVIEW if active
     if (_LIST_VIEW_ENABLED) {
       displayListView(_CURRENT_DIR);
@@ -0,0 +1,138 @@
+/**
+ * Complete
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../Shell.h"
+#include "Menu.h"
+#include "Window.h"
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// complete the last word of line (TAB). a single candidate is taken at
+/// once, otherwise the word is extended as far as the candidates agree, and
+/// if it cannot be extended they are offered in a menu below the prompt.
+/// what was typed is kept as written, and the rest of the word is escaped
+/// to read back as the candidate. the caller redraws the line.
+void Shell::completeLine(std::string &line) {
+  if (!_COMPLETER.commandsLoaded()) {
+    std::vector<std::string> const builtins = builtinNames();
+    char const *path = getenv("PATH");
+    _COMPLETER.loadCommands(builtins, path == nullptr ? _PATH : path);
+  }
+
+  Completions const completions = _COMPLETER.complete(line, _MAX_COMPLETIONS);
+  std::string const typed = line;
+
+  auto const extend = [&](std::string const &candidate) {
+    line = typed + CommandLexer::escape(
+                       std::string_view(candidate).substr(completions.typed),
+                       completions.quote);
+  };
+  auto const take = [&](std::string const &candidate) {
+    extend(candidate);
+    if (completions.quote != 0)
+      line += completions.quote;
+    if (candidate.empty() || candidate.back() != '/')
+      line += ' ';
+  };
+
+  _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
+  int const y = _CURSOR_Y;
+
+  if (completions.total == 0) {
+    bell();
+  } else if (completions.total == 1) {
+    take(completions.candidates[0]);
+  } else if (completions.common.size() > completions.typed) {
+    extend(completions.common);
+  } else {
+    // offer the candidates in a menu below the prompt, or above it when the
+    // prompt is near the bottom of the display.
+    size_t const rows = std::min(completions.candidates.size(),
+                                 std::max<size_t>(_DISPLAY_SIZE_Y / 2, 3));
+    bool const paged = rows < completions.candidates.size();
+    size_t const menuY = y + 1 + rows <= _DISPLAY_SIZE_Y ? y + 1 : y - rows;
+
+    std::vector<std::string> fields;
+    fields.reserve(completions.candidates.size());
+    for (auto const &candidate : completions.candidates)
+      fields.push_back(candidate.substr(0, _DISPLAY_SIZE_X - 1));
+
+    curs_set(0);
+    BlackOS::DisplayKernel::Menu CompletionMenu(rows, _DISPLAY_SIZE_X, menuY,
+                                                0);
+    CompletionMenu.setWin(BlackOS::DisplayKernel::WIN_SET_CODE::INIT_CHILD);
+    if (_USING_COLOR_FLAG)
+      CompletionMenu.bgfg(_FOREGROUND, _BACKGROUND);
+    CompletionMenu.hideBorder();
+    CompletionMenu.hideTitle();
+    CompletionMenu.initFields(fields);
+    CompletionMenu.loadFieldAlignment(-1, 1);
+    // the last row shows the page number when there is more than one page.
+    CompletionMenu.paginate(paged ? rows - 1 : rows, paged);
+    CompletionMenu.setKeypad(true);
+    CompletionMenu.resetHighlighted();
+
+    int selection;
+    while (true) {
+      CompletionMenu.loadFields();
+      selection = CompletionMenu.getCharFromUser(); // calls refresh implicitly
+      if (selection == 10 /*ENTER*/ || selection == 9 /*TAB*/ ||
+          selection == 27 /*ESC*/ || selection == (int)'q')
+        break;
+      switch (selection) {
+      case KEY_LEFT:
+        if (CompletionMenu.page() != 0) {
+          CompletionMenu.backPage();
+          CompletionMenu.eraseWin();
+        }
+        break;
+      case KEY_RIGHT:
+        if (CompletionMenu.page() != CompletionMenu.numPages() - 1) {
+          CompletionMenu.forwardPage();
+          CompletionMenu.eraseWin();
+        }
+        break;
+      case KEY_UP:
+        if (CompletionMenu.highlighted() != 0)
+          CompletionMenu.moveHighlightUp();
+        break;
+      case KEY_DOWN:
+        if (CompletionMenu.highlighted() !=
+            CompletionMenu.numFieldsThisPage() - 1)
+          CompletionMenu.moveHighlightDown();
+        break;
+      default:
+        break;
+      }
+    }
+    if (selection == 10 || selection == 9)
+      take(completions.candidates[CompletionMenu.selectedFieldIndex()]);
+
+    CompletionMenu.eraseWin();
+    CompletionMenu.refresh();
+    CompletionMenu.setWin(BlackOS::DisplayKernel::WIN_SET_CODE::KILL_CHILD);
+    _DISPLAY->touch();
+    curs_set(_CURSOR);
+  }
+}
+} // namespace Trinkets
+} // namespace BlackOS
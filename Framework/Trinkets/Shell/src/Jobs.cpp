@@ -0,0 +1,84 @@
+/**
+ * Tr(inkets) Shell Jobs
+ *
+ * Copyright (C) 2020 by Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../Shell.h"
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// list the jobs stopped with ^Z.
+int Shell::jobs() {
+  // forget jobs that were ended from outside the shell.
+  for (size_t i = 0; i < _JOBS.size();) {
+    if (_JOBS[i].update() == JobState::DONE)
+      _JOBS.erase(_JOBS.begin() + i);
+    else
+      ++i;
+  }
+
+  if (_JOBS.empty()) {
+    _DISPLAY->print("no stopped jobs.");
+    _DISPLAY->newLine();
+    return 0;
+  }
+  for (size_t i = 0; i < _JOBS.size(); ++i) {
+    std::string const line = "[" + std::to_string(i + 1) + "] stopped  " +
+                             _JOBS[i].commandLine();
+    _DISPLAY->write(line);
+    _DISPLAY->newLine();
+  }
+  return 0;
+}
+
+/// continue a stopped job in the foreground: fg [n], most recent by default.
+int Shell::foreground() {
+  if (_JOBS.empty()) {
+    _DISPLAY->print("no stopped jobs.");
+    _DISPLAY->newLine();
+    return 1;
+  }
+
+  size_t n = _JOBS.size();
+  if (_ARGC > 1) {
+    std::string arg = _ARGV[1];
+    if (!arg.empty() && arg[0] == '%')
+      arg.erase(0, 1);
+    char *end = nullptr;
+    n = std::strtoul(arg.c_str(), &end, 10);
+    if (arg.empty() || *end != '\0' || n == 0 || n > _JOBS.size()) {
+      _DISPLAY->print("fg: no such job.", _STYLE_ERROR);
+      _DISPLAY->newLine();
+      return 1;
+    }
+  }
+
+  Job job = std::move(_JOBS[n - 1]);
+  _JOBS.erase(_JOBS.begin() + (n - 1));
+  _DISPLAY->write(job.commandLine(), A_DIM);
+  _DISPLAY->newLine();
+
+  tcgetattr(STDIN_FILENO, &_OLDT);
+  foregroundJob(job);
+  tcsetattr(STDIN_FILENO, TCSANOW, &_OLDT);
+  return 0;
+}
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,58 @@
+/**
+ * Jump
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../Shell.h"
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// change to the best ranked directory matching the fragments given:
+/// j <fragment>...
+int Shell::jump() {
+  if (_ARGC < 2) {
+    _DISPLAY->print("usage: j <fragment>...", _STYLE_ERROR);
+    _DISPLAY->newLine();
+    return 1;
+  }
+
+  std::vector<std::string> const fragments(_ARGV.begin() + 1, _ARGV.end());
+  for (auto const &candidate : _DIRECTORY_RANK.match(fragments)) {
+    std::string const &path = candidate.first;
+    if (path == _CURRENT_DIR.string())
+      continue;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(path, ec)) {
+      _DIRECTORY_RANK.forget(path);
+      continue;
+    }
+    _DISPLAY->write(path, A_DIM);
+    _DISPLAY->newLine();
+    _ARGV = {"cd", path};
+    _ARGC = 2;
+    return changeDir();
+  }
+
+  _DISPLAY->print("j: no ranked directory matches.", _STYLE_ERROR);
+  _DISPLAY->newLine();
+  return 1;
+}
+} // namespace Trinkets
+} // namespace BlackOS
@@ -28,7 +28,7 @@ namespace Trinkets {
 
 int Shell::listChildren() {
 
-  bool withHidden;
+  bool withHidden = false;
   std::string initPath;
 
   if (_ARGC == 1) {
@@ -87,16 +87,38 @@ int Shell::listChildren() {
   std::vector<std::filesystem::path> children;
 
   // create path navigator object;
-  BlackOS::Trinkets::PathController pathController;
+  BlackOS::Trinkets::PathController pathController(&_DIRECTORY_CACHE);
   pathController.showHidden(withHidden);
+  pathController.sortBy(_SORT_ORDER);
 
   try {
-    pathController.loadParent(parentPath);
+    pathController.loadProgressively(parentPath);
   } catch (std::filesystem::filesystem_error &e) {
     std::cout << e.what() << std::endl;
     return -1;
   }
 
+  // count up while a large directory is read.
+  int y, x;
+  _DISPLAY->cursorPosition(y, x);
+  size_t shownLen = 0;
+  while (pathController.loading()) {
+    pathController.poll(_LOADING_POLL_MS);
+    if (!pathController.loading())
+      break;
+    std::string const count =
+        "loading " + std::to_string(pathController.loaded()) + "...";
+    _DISPLAY->moveCursor(y, x);
+    _DISPLAY->write(count, _STYLE_INFO);
+    _DISPLAY->refresh();
+    shownLen = count.length();
+  }
+  if (shownLen != 0) {
+    _DISPLAY->moveCursor(y, x);
+    _DISPLAY->write(std::string(shownLen, ' '));
+    _DISPLAY->moveCursor(y, x);
+  }
+
   title = pathController.generateTitle();
   fields = pathController.generateFields();
 
@@ -33,7 +33,7 @@ int Shell::navigateDir() {
   curs_set(0);
   _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
 
-  bool withHidden;
+  bool withHidden = false;
   std::string initPath;
 
   int y, x;
@@ -105,11 +105,9 @@ int Shell::navigateDir() {
   std::string chosenPath;
   size_t fieldIdx;
   size_t fieldSz;
-  std::vector<std::string> fields;
-  std::vector<std::filesystem::path> children;
 
   std::string title;
-  size_t menuWidth;
+  size_t menuWidth = 0;
   size_t menuHeight;
   size_t pagination;
 
@@ -122,11 +120,20 @@ int Shell::navigateDir() {
   // variable.
   // 'q' or 'ESC' key to exit navigation menu.
   // 's' to enter shortcus
-  std::vector<int> breakConditions = {(int)'a',   (int)'d', (int)'q',
-                                      (int)'h',   (int)'e', 10 /*ENTER*/,
-                                      27 /*ESC*/, (int)'s'};
+  // 'o' to cycle through the sort orders.
+  // 'D' to toggle showing directories only.
+  // 'x' to show only paths with the extension of the highlighted one, or
+  // all paths again.
+  std::vector<int> breakConditions = {
+      (int)'a', (int)'d', (int)'q', (int)'h', (int)'e', 10 /*ENTER*/,
+      27 /*ESC*/, (int)'s', (int)'o', (int)'D', (int)'x'};
 
   std::string hiddenAttribute = "showing hidden paths: ";
+  std::string orderAttribute = "   sorted by: ";
+  SortOrder order = _SORT_ORDER;
+  bool directoriesOnly = false;
+  std::string extension; // of the only paths shown, if not empty
+  bool reload = true;    // false when only the order or a filter changed
 
   // create menu object
   BlackOS::DisplayKernel::Menu NavigationMenu(_DISPLAY_SIZE_Y - menuPos,
@@ -137,7 +144,9 @@ int Shell::navigateDir() {
       1, _DISPLAY_SIZE_X - currentDirPos, currentDirPos, 0);
 
   // create path navigator object;
-  PathController pathController;
+  PathController pathController(&_DIRECTORY_CACHE);
+  // reads ahead the directories around the highlight.
+  DirectoryPrefetcher &prefetcher = directoryPrefetcher();
 
   NavigationMenu.setWin(DK::WIN_SET_CODE::INIT_CHILD);
   CurrentDirWindow.setWin(DK::WIN_SET_CODE::INIT_CHILD);
@@ -150,45 +159,79 @@ int Shell::navigateDir() {
   while (1) {
 
     pathController.showHidden(withHidden);
-
-    try {
-      pathController.loadParent(parentPath);
-    } catch (std::filesystem::filesystem_error &e) {
-      NavigationMenu.eraseWin();
-      NavigationMenu.insert(e.what(), 0, 0);
-      NavigationMenu.refresh();
-      NavigationMenu.pause();
-      if (parentPath == initPath) {
-        // user initialised parent directory without access
-        NavigationMenu.setWin(BlackOS::DisplayKernel::WIN_SET_CODE::KILL_CHILD);
-        CurrentDirWindow.setWin(
-            BlackOS::DisplayKernel::WIN_SET_CODE::KILL_CHILD);
-        _DISPLAY->moveCursor(_CURSOR_Y, 0);
-        curs_set(_CURSOR);
-        _DISPLAY->refresh();
-        return -1; // leave here TODO: exit codes
-      } else {
-        // user navigated into directory without permissions
-        // return to parent directory.
-        parentPath = parentPath.parent_path();
+    pathController.showDirectoriesOnly(directoriesOnly);
+    pathController.showExtension(extension);
+    pathController.sortBy(order);
+
+    if (!reload) {
+      // the children loaded, hidden ones included, are arranged again
+      // rather than read again.
+      reload = true;
+      pathController.rearrange();
+    } else {
+      prefetcher.collect();
+      try {
+        pathController.loadProgressively(parentPath);
+      } catch (std::filesystem::filesystem_error &e) {
+        NavigationMenu.eraseWin();
+        NavigationMenu.insert(e.what(), 0, 0);
+        NavigationMenu.refresh();
+        NavigationMenu.pause();
+        if (parentPath == initPath) {
+          // user initialised parent directory without access
+          NavigationMenu.setWin(
+              BlackOS::DisplayKernel::WIN_SET_CODE::KILL_CHILD);
+          CurrentDirWindow.setWin(
+              BlackOS::DisplayKernel::WIN_SET_CODE::KILL_CHILD);
+          _DISPLAY->moveCursor(_CURSOR_Y, 0);
+          curs_set(_CURSOR);
+          _DISPLAY->refresh();
+          return -1; // leave here TODO: exit codes
+        } else {
+          // user navigated into directory without permissions
+          // return to parent directory.
+          parentPath = parentPath.parent_path();
+        }
+        continue;
       }
-      continue;
     }
 
-    fields = pathController.generateFields();
+    menuHeight = _DISPLAY_SIZE_Y - menuPos;
+    pagination = menuHeight - 3;
+
+    // show the first page as soon as it is full; the rest of a large
+    // directory is taken in between keys.
+    while (pathController.loading() &&
+           pathController.childrenSize() < pagination)
+      pathController.poll(_LOADING_POLL_MS);
     title = pathController.generateTitle();
-    children = pathController.children();
-    fieldSz = fields.size();
+    fieldSz = pathController.childrenSize();
+
+    // a narrower menu leaves the erased rows of the last one on screen
+    // unless they are drawn blank first.
+    if (title.length() + 1 < menuWidth)
+      NavigationMenu.refresh();
 
     // include 1 additional space.
     menuWidth = title.length() + 1;
-    menuHeight = _DISPLAY_SIZE_Y - menuPos;
-    pagination = menuHeight - 3;
 
     NavigationMenu.resize(menuHeight, menuWidth);
     NavigationMenu.reposition(menuPos /*maintain cursor _CURSOR_Y position*/,
                               0 /*left of screen*/);
 
+    if (fieldSz == 0 && (directoriesOnly || !extension.empty())) {
+      // nothing here passes the filters; show everything again.
+      NavigationMenu.eraseWin();
+      NavigationMenu.print("no entries match the filter.");
+      NavigationMenu.refresh();
+      NavigationMenu.pause();
+      directoriesOnly = false;
+      extension.clear();
+      reload = false;
+      NavigationMenu.eraseWin();
+      CurrentDirWindow.eraseWin();
+      continue;
+    }
     if (fieldSz == 0) {
       std::string message;
       if (withHidden) {
@@ -211,7 +254,11 @@ int Shell::navigateDir() {
     NavigationMenu.hideBorder();
     NavigationMenu.loadTitle(title, A_BOLD);
     NavigationMenu.showTitle();
-    NavigationMenu.initFields(fields);
+    // fields are made a page at a time.
+    auto const fieldOf = [&pathController](size_t const idx) {
+      return pathController.field(idx);
+    };
+    NavigationMenu.initFields(fieldSz, fieldOf, title.length());
     NavigationMenu.loadFieldAlignment(-1, 1);
     NavigationMenu.paginate(pagination, pagination <= fieldSz);
 
@@ -230,7 +277,19 @@ int Shell::navigateDir() {
     CurrentDirWindow.moveCursor(0, 0);
     CurrentDirWindow.print(currentDirMessage, A_BOLD);
     CurrentDirWindow.print(currentDir);
+    CurrentDirWindow.print(orderAttribute, A_BOLD);
+    CurrentDirWindow.print(sortOrderName(order));
+    std::string filterInfo;
+    if (directoriesOnly)
+      filterInfo += "   directories only";
+    if (!extension.empty())
+      filterInfo += "   only *" + extension;
+    CurrentDirWindow.print(filterInfo, A_BOLD);
     CurrentDirWindow.refresh();
+    size_t const currentDirLen =
+        currentDirMessage.length() + currentDir.length() +
+        orderAttribute.length() + strlen(sortOrderName(order)) +
+        filterInfo.length();
 
     std::vector<size_t> ignoreBlocks = {attributePosition, 0, attributePosition,
                                         hiddenInfo.length()};
@@ -238,6 +297,33 @@ int Shell::navigateDir() {
     NavigationMenu.print(hiddenInfo);
     NavigationMenu.refresh();
 
+    // while loading, count the children read so far after the path.
+    size_t loadingLen = 0;
+    auto const showLoading = [&]() {
+      std::string count;
+      if (pathController.loading())
+        count = "   loading " + std::to_string(pathController.loaded()) + "...";
+      size_t const len = count.length();
+      count.resize(std::max(len, loadingLen), ' ');
+      loadingLen = len;
+      CurrentDirWindow.moveCursor(0, currentDirLen);
+      CurrentDirWindow.write(count, _STYLE_INFO);
+      CurrentDirWindow.refresh();
+    };
+    showLoading();
+
+    // the highlighted child and those either side of it are the likeliest
+    // to be opened next; have the directories among them read meanwhile.
+    auto const prefetchAround = [&]() {
+      size_t const selectedIdx = NavigationMenu.selectedFieldIndex();
+      std::vector<std::filesystem::path> paths;
+      for (size_t const idx : {selectedIdx, selectedIdx + 1, selectedIdx - 1})
+        if (idx < pathController.childrenSize() &&
+            pathController.type(idx) == PathType::DIRECTORY)
+          paths.push_back(pathController.childPath(idx));
+      prefetcher.prefetch(paths, order);
+    };
+
     // NavigationMenu.display(breakConditions, ignoreBlocks);
 
     int selection;
@@ -245,28 +331,59 @@ int Shell::navigateDir() {
     NavigationMenu.resetHighlighted();
     NavigationMenu.setKeypad(true);
 
-    // initial LSVIEW window
-    if (_LIST_VIEW_ENABLED) {
-      auto listViewPath = children[NavigationMenu.highlighted()];
-      if (pathController.pathType(listViewPath) == "directory") {
-        try {
-          displayListView(listViewPath);
-        } catch (std::filesystem::filesystem_error &e) {
-          _LSVIEW->eraseWin();
-          _LSVIEW->print(e.what());
-          _LSVIEW->refresh();
-        }
-      } else {
-        _LSVIEW->eraseWin();
-        _LSVIEW->print("not a directory!");
-        _LSVIEW->refresh();
-      }
-    }
+    // the list view follows the highlight once it rests on a child.
+    auto const previewHighlighted = [&]() {
+      if (!_LIST_VIEW_ENABLED)
+        return;
+      size_t const idx = NavigationMenu.selectedFieldIndex();
+      previewListView(pathController.type(idx) == PathType::DIRECTORY
+                          ? pathController.childPath(idx)
+                          : std::filesystem::path());
+    };
+    previewHighlighted();
+    prefetchAround();
 
     while (true) {
 
       NavigationMenu.loadFields();
+      // wait for a key only as long as a load or a preview can be left.
+      int const previewWait = updateListView();
+      int const loadingWait = pathController.loading() ? _LOADING_POLL_MS : -1;
+      NavigationMenu.setInputTimeout(
+          previewWait < 0 || loadingWait < 0
+              ? std::max(previewWait, loadingWait)
+              : std::min(previewWait, loadingWait));
       selection = NavigationMenu.getCharFromUser(); // calls refresh implicitly
+      if (selection == ERR && !pathController.loading())
+        continue; // a preview is due
+      if (selection == ERR) {
+        // no key yet: take in what has been read meanwhile. once the user
+        // has moved the highlight, it stays on the same child as the order
+        // changes; until then it stays at the top.
+        size_t const selectedIdx = NavigationMenu.selectedFieldIndex();
+        uint32_t const selected = pathController.id(selectedIdx);
+        if (pathController.poll()) {
+          fieldSz = pathController.childrenSize();
+          title = pathController.generateTitle();
+          if (title.length() + 1 > menuWidth) {
+            menuWidth = title.length() + 1;
+            NavigationMenu.resize(menuHeight, menuWidth);
+          }
+          NavigationMenu.eraseWin();
+          NavigationMenu.loadTitle(title, A_BOLD);
+          NavigationMenu.showTitle();
+          NavigationMenu.paginate(pagination, pagination <= fieldSz);
+          NavigationMenu.initFields(fieldSz, fieldOf, title.length());
+          if (selectedIdx != 0)
+            NavigationMenu.showField(pathController.find(selected));
+          NavigationMenu.moveCursor(attributePosition, 0);
+          NavigationMenu.print(hiddenInfo);
+          prefetchAround();
+          previewHighlighted();
+        }
+        showLoading();
+        continue;
+      }
       currentPage = NavigationMenu.page();
       switch (selection) {
       case KEY_LEFT:
@@ -285,49 +402,22 @@ int Shell::navigateDir() {
       case KEY_UP:
         if (NavigationMenu.highlighted() != 0) {
           NavigationMenu.moveHighlightUp();
-          if (_LIST_VIEW_ENABLED) {
-            auto listViewPath = children[NavigationMenu.highlighted()];
-            if (pathController.pathType(listViewPath) == "directory") {
-              try {
-                displayListView(listViewPath);
-              } catch (std::filesystem::filesystem_error &e) {
-                _LSVIEW->eraseWin();
-                _LSVIEW->print(e.what());
-                _LSVIEW->refresh();
-              }
-            } else {
-              _LSVIEW->eraseWin();
-              _LSVIEW->print("not a directory!");
-              _LSVIEW->refresh();
-            }
-          }
         }
         break;
       case KEY_DOWN:
         if (NavigationMenu.highlighted() !=
             NavigationMenu.numFieldsThisPage() - 1) { // numFieldsThisPage()
           NavigationMenu.moveHighlightDown();         // moveHighlightUp()
-          if (_LIST_VIEW_ENABLED) {
-            auto listViewPath = children[NavigationMenu.highlighted()];
-            if (pathController.pathType(listViewPath) == "directory") {
-              try {
-                displayListView(listViewPath);
-              } catch (std::filesystem::filesystem_error &e) {
-                _LSVIEW->eraseWin();
-                _LSVIEW->print(e.what());
-                _LSVIEW->refresh();
-              }
-            } else {
-              _LSVIEW->eraseWin();
-              _LSVIEW->print("not a directory!");
-              _LSVIEW->refresh();
-            }
-          }
         }
         break;
       default:
         break;
       }
+      if (selection == KEY_UP || selection == KEY_DOWN ||
+          selection == KEY_LEFT || selection == KEY_RIGHT) {
+        prefetchAround();
+        previewHighlighted();
+      }
 
       bool exitStatus = 0;
       for (const int i : breakConditions) {
@@ -376,11 +466,11 @@ int Shell::navigateDir() {
 
       // assign new path to chosen path in children,
       // mapped by fieldIdx.
-      auto newPath = children[fieldIdx];
+      auto newPath = pathController.childPath(fieldIdx);
 
       // check the path is a directory
       // set parent to this path if true
-      if (pathController.pathType(newPath) == "directory") {
+      if (pathController.type(fieldIdx) == PathType::DIRECTORY) {
         parentPath = newPath;
       }
       // clear window for next iteration
@@ -393,7 +483,33 @@ int Shell::navigateDir() {
       } else {
         withHidden = 1;
       }
+      reload = false;
+      NavigationMenu.eraseWin();
+    } else if (selection == (int)'o') {
+      // next sort order
+      order = static_cast<SortOrder>((static_cast<size_t>(order) + 1) %
+                                     SORT_ORDERS);
+      reload = false;
       NavigationMenu.eraseWin();
+      CurrentDirWindow.eraseWin(); // the order is named there
+    } else if (selection == (int)'D') {
+      // toggle showing directories only
+      directoriesOnly = !directoriesOnly;
+      reload = false;
+      NavigationMenu.eraseWin();
+      CurrentDirWindow.eraseWin();
+    } else if (selection == (int)'x') {
+      // filter by the extension of the highlighted path, or stop filtering
+      if (extension.empty()) {
+        fieldIdx = NavigationMenu.selectedFieldIndex();
+        std::filesystem::path const name(pathController.name(fieldIdx));
+        extension = name.extension();
+      } else {
+        extension.clear();
+      }
+      reload = false;
+      NavigationMenu.eraseWin();
+      CurrentDirWindow.eraseWin();
     } else if (selection == (int)'e') {
 
       // exit at parent directory
@@ -439,9 +555,9 @@ int Shell::navigateDir() {
 
       // last key pressed is enter
       fieldIdx = NavigationMenu.selectedFieldIndex();
-      chosenPath = children[fieldIdx];
-      auto chosenPathType = pathController.pathType(chosenPath);
-      if (chosenPathType == "directory") {
+      chosenPath = pathController.childPath(fieldIdx);
+      PathType const chosenPathType = pathController.type(fieldIdx);
+      if (chosenPathType == PathType::DIRECTORY) {
         _ARGV = {"cd", chosenPath};
         _ARGC = 2;
 
@@ -454,7 +570,7 @@ int Shell::navigateDir() {
             BlackOS::DisplayKernel::WIN_SET_CODE::KILL_CHILD);
         changeDir();
         break;
-      } else if (chosenPathType == "file") {
+      } else if (chosenPathType == PathType::FILE) {
         int result = openWithTextEditor(chosenPath);
         curs_set(_CURSOR); // TODO: find where to put this
         NavigationMenu.eraseWin();
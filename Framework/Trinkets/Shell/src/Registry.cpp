@@ -0,0 +1,114 @@
+/**
+ * Registry
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../Shell.h"
+#include "../../helpers/PerfectHash.h"
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+uint8_t const MANY = UINT8_MAX; // no limit on arguments
+} // namespace
+
+// built-in commands, with the number of words each accepts, and programs
+// whose output is captured and drawn as text rather than run on a terminal.
+constexpr Shell::Builtin BUILTINS[] = {
+    {"bell", &Shell::bell, 1, MANY, false},
+    {"cd", &Shell::changeDir, 1, 2, false},
+    {"clear", &Shell::clearScreen, 1, MANY, false},
+    {"configure", &Shell::configure, 3, 3, false},
+    {"config", &Shell::configure, 3, 3, false},
+    {"ls", &Shell::listChildren, 1, 3, false},
+    {"lsconfig", &Shell::listConfigVariables, 1, MANY, false},
+    {"nd", &Shell::navigateDir, 1, 3, false},
+    {"ndir", &Shell::navigateDir, 1, 3, false},
+    {"rainbow", &Shell::rainbow, 1, MANY, false},
+    {"sc", &Shell::shortcut, 1, MANY, false},
+    {"shortcut", &Shell::shortcut, 1, MANY, false},
+    {"memory", &Shell::printMemoryHistory, 1, MANY, false},
+    {"lsview", &Shell::listView, 1, MANY, false},
+    {"cpos", &Shell::cpos, 1, MANY, false},
+    {"move", &Shell::MOVE, 3, 3, false},
+    {"scrollback", &Shell::scrollback, 1, MANY, false},
+    {"jobs", &Shell::jobs, 1, MANY, false},
+    {"fg", &Shell::foreground, 1, 2, false},
+    {"j", &Shell::jump, 1, MANY, false},
+    {"make", nullptr, 1, MANY, true},
+    {"ps", nullptr, 1, MANY, true},
+    {"ss", nullptr, 1, MANY, true},
+    {"nproc", nullptr, 1, MANY, true},
+    {"lspci", nullptr, 1, MANY, true},
+    {"dir", nullptr, 1, MANY, true},
+    {"acpi", nullptr, 1, MANY, true},
+};
+
+// keys of config.txt and of the configure command.
+constexpr Shell::Builtin CONFIG_KEYS[] = {
+    {"BG", &Shell::configBackgroundColour, 3, 3, false},
+    {"CURSOR", &Shell::configCursor, 3, 3, false},
+    {"CURSCOL", &Shell::configCursorColour, 3, 3, false},
+    {"DELETE", &Shell::configDeleteKey, 3, 3, false},
+    {"FG", &Shell::configForegroundColour, 3, 3, false},
+    {"THEME", &Shell::configTheme, 3, 3, false},
+    {"LSVIEW", &Shell::configListView, 3, 3, false},
+    {"FRAMERATE", &Shell::configFrameRate, 3, 3, false},
+    {"SORT", &Shell::configSortOrder, 3, 3, false},
+};
+
+constexpr Shell::Builtin THEMES[] = {
+    {"invader", &Shell::configThemeInvader, 3, 3, false},
+    {"ire", &Shell::configThemeIre, 3, 3, false},
+    {"neptune", &Shell::configThemeNeptune, 3, 3, false},
+    {"classic", &Shell::configThemeClassic, 3, 3, false},
+    {"anticlassic", &Shell::configThemeAntiClassic, 3, 3, false},
+    {"thinkpad", &Shell::configThemeThinkPad, 3, 3, false},
+    {"system", &Shell::configThemeSystem, 3, 3, false},
+    {"ugly", &Shell::configThemeUgly, 3, 3, false},
+};
+
+Shell::Builtin const *Shell::findBuiltin(std::string_view const name) {
+  static constexpr PerfectHash<Builtin, std::size(BUILTINS)> table(BUILTINS);
+  return table.find(name);
+}
+
+Shell::Builtin const *Shell::findConfigKey(std::string_view const name) {
+  static constexpr PerfectHash<Builtin, std::size(CONFIG_KEYS)> table(
+      CONFIG_KEYS);
+  return table.find(name);
+}
+
+Shell::Builtin const *Shell::findTheme(std::string_view const name) {
+  static constexpr PerfectHash<Builtin, std::size(THEMES)> table(THEMES);
+  return table.find(name);
+}
+
+/// the names of the commands the shell runs itself.
+std::vector<std::string> Shell::builtinNames() {
+  std::vector<std::string> names;
+  for (auto const &builtin : BUILTINS)
+    if (builtin.run != nullptr)
+      names.emplace_back(builtin.name);
+  return names;
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,93 @@
+/**
+ * ReverseSearch
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../Shell.h"
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// search the history backwards as the query is typed (^R). ^R again finds
+/// an older match, Enter runs the match, the arrow keys keep it for editing
+/// and ESC or ^G leave the line as it was. returns true if the match should
+/// be run. the caller redraws the line.
+bool Shell::reverseSearch(std::string &line) {
+  _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
+  int const y = _CURSOR_Y;
+  size_t const width = _DISPLAY_SIZE_X - _PROMPT_LEN - 1;
+
+  std::string query;
+  long match = -1;
+
+  auto const draw = [&]() {
+    std::string text = match < 0 && !query.empty() ? "failed reverse search `"
+                                                    : "reverse search `";
+    text += query + "': ";
+    if (match >= 0)
+      text += _HISTORY.entry(match);
+    _DISPLAY->erase(y, _PROMPT_LEN, y, _DISPLAY_SIZE_X - 1);
+    _DISPLAY->insert(text.substr(0, width), y, _PROMPT_LEN);
+    _DISPLAY->refresh();
+  };
+
+  bool run = false;
+  draw();
+  while (true) {
+    int const ch = _DISPLAY->getCharFromUser();
+    if (ch == '\n' || ch == KEY_ENTER) {
+      if (match >= 0) {
+        line = _HISTORY.entry(match);
+        run = true;
+      }
+      break;
+    } else if (ch == KEY_LEFT || ch == KEY_RIGHT || ch == KEY_UP ||
+               ch == KEY_DOWN) {
+      if (match >= 0)
+        line = _HISTORY.entry(match);
+      break;
+    } else if (ch == 27 /*ESC*/ || ch == 7 /*^G*/) {
+      break;
+    } else if (ch == 18 /*^R*/) {
+      long const older = match > 0 ? _HISTORY.search(query, match) : -1;
+      if (older < 0)
+        bell();
+      else
+        match = older;
+    } else if ((_DELETE > 0 && ch == _DELETE) || ch == 8 ||
+               ch == KEY_BACKSPACE || ch == 127) {
+      if (!query.empty())
+        query.pop_back();
+      match = _HISTORY.search(query, _HISTORY.size());
+    } else if (ch >= ' ' && ch < 127) {
+      // a longer query can only match the current match or an older one,
+      // and cannot match at all once the shorter one has failed.
+      bool const failed = match < 0 && !query.empty();
+      query += (char)ch;
+      if (!failed)
+        match = _HISTORY.search(query, match >= 0 ? match + 1
+                                                  : _HISTORY.size());
+    }
+    draw();
+  }
+
+  return run;
+}
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,124 @@
+/**
+ * Tr(inkets) Shell Scrollback
+ *
+ * Copyright (C) 2020 by Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "../Shell.h"
+#include "Menu.h"
+#include "Window.h"
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// page through captured command output, including lines that were skipped
+/// while rendering could not keep up.
+int Shell::scrollback() {
+  if (_SCROLLBACK.empty()) {
+    _DISPLAY->print("scrollback is empty.");
+    _DISPLAY->newLine();
+    return 0;
+  }
+
+  curs_set(0);
+  _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
+
+  size_t menuHeight = _DISPLAY_SIZE_Y;
+  size_t menuWidth = _DISPLAY_SIZE_X;
+  size_t pagination = menuHeight - 2;
+
+  // fields must fit on one row of the menu, and are shown without colour.
+  std::vector<std::string> fields;
+  fields.reserve(_SCROLLBACK.size());
+  for (auto const &line : _SCROLLBACK)
+    fields.push_back(
+        DisplayKernel::AnsiText::strip(line).substr(0, menuWidth - 1));
+
+  BlackOS::DisplayKernel::Menu ScrollbackMenu(menuHeight, menuWidth, 0, 0);
+  ScrollbackMenu.setWin(BlackOS::DisplayKernel::WIN_SET_CODE::INIT_CHILD);
+  if (_USING_COLOR_FLAG) {
+    ScrollbackMenu.bgfg(_FOREGROUND, _BACKGROUND);
+  }
+
+  ScrollbackMenu.hideBorder();
+  ScrollbackMenu.loadTitle("scrollback", A_BOLD);
+  ScrollbackMenu.showTitle();
+  ScrollbackMenu.initFields(fields);
+  ScrollbackMenu.loadFieldAlignment(-1, 1);
+  ScrollbackMenu.paginate(pagination, pagination <= fields.size());
+  ScrollbackMenu.setKeypad(true);
+
+  // open on the most recent page.
+  ScrollbackMenu.resetHighlighted();
+  while (ScrollbackMenu.page() != ScrollbackMenu.numPages() - 1)
+    ScrollbackMenu.forwardPage();
+
+  std::vector<int> breakConditions = {(int)'q', 10 /*ENTER*/, 27 /*ESC*/};
+
+  int selection;
+  while (true) {
+    ScrollbackMenu.loadFields();
+    selection = ScrollbackMenu.getCharFromUser(); // calls refresh implicitly
+    switch (selection) {
+    case KEY_LEFT:
+      if (ScrollbackMenu.page() != 0) {
+        ScrollbackMenu.backPage();
+        ScrollbackMenu.eraseWin();
+      }
+      break;
+    case KEY_RIGHT:
+      if (ScrollbackMenu.page() != ScrollbackMenu.numPages() - 1) {
+        ScrollbackMenu.forwardPage();
+        ScrollbackMenu.eraseWin();
+      }
+      break;
+    case KEY_UP:
+      if (ScrollbackMenu.highlighted() != 0)
+        ScrollbackMenu.moveHighlightUp();
+      break;
+    case KEY_DOWN:
+      if (ScrollbackMenu.highlighted() !=
+          ScrollbackMenu.numFieldsThisPage() - 1)
+        ScrollbackMenu.moveHighlightDown();
+      break;
+    default:
+      break;
+    }
+
+    bool exitStatus = 0;
+    for (const int i : breakConditions) {
+      if (selection == i) {
+        exitStatus = 1;
+      }
+    }
+    if (exitStatus) {
+      break;
+    }
+  }
+
+  ScrollbackMenu.eraseWin();
+  ScrollbackMenu.refresh();
+  ScrollbackMenu.setWin(BlackOS::DisplayKernel::WIN_SET_CODE::KILL_CHILD);
+  _DISPLAY->touch();
+  _DISPLAY->moveCursor(_CURSOR_Y, 0);
+  curs_set(_CURSOR);
+  _DISPLAY->refresh();
+  return 0;
+}
+} // namespace Trinkets
+} // namespace BlackOS
@@ -24,6 +24,18 @@
 namespace BlackOS {
 namespace Trinkets {
 
+namespace {
+// set by the signal handlers, checked by loops waiting on a child process.
+volatile sig_atomic_t INTERRUPT_RECEIVED = 0; // SIGINT
+volatile sig_atomic_t SUSPEND_RECEIVED = 0;   // SIGTSTP
+volatile sig_atomic_t CHILD_CHANGED = 0;      // SIGCHLD
+
+// keys for the markers a terminal puts around pasted text in bracketed
+// paste mode.
+int const KEY_PASTE_BEGIN = KEY_MAX + 1;
+int const KEY_PASTE_END = KEY_MAX + 2;
+} // namespace
+
 /// generates a shared pointer to DisplayKernel Screen instance.
 Window_sptr generateSharedWindow() {
   auto win = std::make_shared<DisplayKernel::Window>(0, 0, 0, 0);
@@ -79,7 +91,10 @@ int Shell::configListView() {
     return 1;
   }
   std::string value = _ARGV[2];
-  if (value == "TRUE" || value == "1") {
+  if ((value == "TRUE" || value == "1") && _STARTUP_PENDING) {
+    // filled in once the first prompt is up.
+    _LIST_VIEW_PENDING = true;
+  } else if (value == "TRUE" || value == "1") {
     _CURRENT_DIR = _HOME;
     listView(1);
   } else if (value != "FALSE" || value != "0")
@@ -87,6 +102,45 @@ int Shell::configListView() {
   return 0;
 }
 
+int Shell::configFrameRate() {
+  if (_ARGC != 3) {
+    _DISPLAY->print("not enough arguments!\n");
+    return 1;
+  }
+  std::string errorMessage = "could not assign frame rate to this value: " +
+                             _ARGV[2] +
+                             "\n2nd argument must be in range: 1 <= [arg2] <= 240";
+  int value;
+  try {
+    value = std::stoi(_ARGV[2]);
+  } catch (...) {
+    value = 0;
+  }
+  if (value < 1 || value > 240) {
+    _DISPLAY->print(errorMessage.c_str());
+    _DISPLAY->newLine();
+    return 1;
+  }
+  _FRAME_RATE = value;
+  return 0;
+}
+
+int Shell::configSortOrder() {
+  if (_ARGC != 3) {
+    _DISPLAY->print("not enough arguments!\n");
+    return 1;
+  }
+  if (parseSortOrder(_ARGV[2], _SORT_ORDER) != 0) {
+    _DISPLAY->write("could not sort by " + _ARGV[2] +
+                        "\n2nd argument must be one of: name, natural, "
+                        "mtime, size, type",
+                    _STYLE_ERROR);
+    _DISPLAY->newLine();
+    return 1;
+  }
+  return 0;
+}
+
 int Shell::configTheme() {
   if (_ARGC != 3) {
     _DISPLAY->print("not enough arguments!\n");
@@ -94,11 +148,10 @@ int Shell::configTheme() {
   }
   std::string theme = _ARGV[2];
 
-  command_map::const_iterator x;
-  x = _THEME_MAP.find(theme);
+  Builtin const *const x = findTheme(theme);
 
-  if (x != _THEME_MAP.end()) {
-    (this->*(x->second))(); // call using pointer
+  if (x != nullptr) {
+    (this->*(x->run))(); // call using pointer
     return 0;
   } else {
     std::string message = "theme " + theme + " is unrecognised.";
@@ -125,14 +178,8 @@ int Shell::configThemeInvader() {
   _STD_FG = standardColours::GREEN;
   _STD_BG = standardColours::BLACK;
 
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
   _USING_COLOR_FLAG = 1;
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
@@ -153,14 +200,8 @@ int Shell::configThemeIre() {
   _STD_FG = standardColours::RED;
   _STD_BG = standardColours::BLACK;
 
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
   _USING_COLOR_FLAG = 1;
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
@@ -181,14 +222,8 @@ int Shell::configThemeClassic() {
   _STD_FG = standardColours::WHITE;
   _STD_BG = standardColours::BLACK;
 
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
   _USING_COLOR_FLAG = 1;
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
@@ -209,14 +244,8 @@ int Shell::configThemeThinkPad() {
   _STD_FG = standardColours::WHITE;
   _STD_BG = standardColours::BLACK;
 
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
   _USING_COLOR_FLAG = 1;
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
@@ -237,14 +266,8 @@ int Shell::configThemeAntiClassic() {
   _STD_FG = standardColours::BLACK;
   _STD_BG = standardColours::WHITE;
 
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
   _USING_COLOR_FLAG = 1;
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
@@ -265,14 +288,8 @@ int Shell::configThemeNeptune() {
   _STD_FG = standardColours::WHITE;
   _STD_BG = standardColours::BLUE;
 
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
   _USING_COLOR_FLAG = 1;
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
@@ -293,16 +310,8 @@ int Shell::configThemeSystem() {
   _STD_FG = standardColours::WHITE;
   _STD_BG = standardColours::BLACK;
 
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  bkgd(COLOR_PAIR(0));
-
   _USING_COLOR_FLAG = 0;
-
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
@@ -320,16 +329,32 @@ int Shell::configThemeUgly() {
   _BACKGROUND = COLOR_YELLOW;
   _CURSOR_COLOUR = "black";
 
-  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
-  fflush(stdout);
-
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
   _USING_COLOR_FLAG = 1;
-  _DISPLAY->refresh();
+  repaint();
 
   return 0;
 }
 
+/// show the current colours and cursor colour. while settings are being
+/// loaded this is put off until they have all been applied.
+void Shell::repaint() {
+  if (_DEFER_REPAINT) {
+    _REPAINT_PENDING = true;
+    return;
+  }
+  _REPAINT_PENDING = false;
+
+  if (_USING_COLOR_FLAG) {
+    printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
+    _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
+  } else {
+    bkgd(COLOR_PAIR(0));
+  }
+  printf("\e]12;%s\a", _CURSOR_COLOUR.c_str());
+  fflush(stdout);
+  _DISPLAY->refresh();
+}
+
 /// alternate colours in screen
 int Shell::rainbow() {
   auto start = std::chrono::system_clock::now();
@@ -372,10 +397,12 @@ void Shell::appendTofile(std::filesystem::path const &path,
 }
 
 /// load the shell to screen
-void Shell::loadShell() {
+void Shell::loadShell(bool const fastStart) {
   _DISPLAY->setWin(BlackOS::DisplayKernel::WIN_SET_CODE::INIT_PARENT);
   _DISPLAY->setKeypad(1);
   _DISPLAY->setScroll(1);
+  define_key("\e[200~", KEY_PASTE_BEGIN);
+  define_key("\e[201~", KEY_PASTE_END);
   // load default colour scheme
   // noraw();
   cbreak();
@@ -404,7 +431,9 @@ void Shell::loadShell() {
 
   std::vector<std::string> v{title, version,  repo,   license,
                              year,  language, author, git};
-  splashScreen(v);
+  if (!fastStart)
+    splashScreen(v);
+  markStartup("window and splash");
 
   // check colour support
   _COLOUR_SUPPORT = has_colors();
@@ -423,14 +452,15 @@ void Shell::loadShell() {
     _STYLE_INFO = COLOR_PAIR(3);
     _STYLE_IMPORTANT = A_STANDOUT;
   }
+  markStartup("colours");
 
   // initialise shell with config settings and shell variables described in
   // config and environment files.
+  _STARTUP_PENDING = fastStart;
   initShellVariables();
-  resetArgs();
-
+  markStartup("apply config");
   initEnvironmentVariables();
-  resetArgs();
+  markStartup("apply environment");
 
   // recommended environment variables
   char *editor = getenv("EDITOR");
@@ -441,21 +471,84 @@ void Shell::loadShell() {
 
   changeDir();
   _DISPLAY->refresh();
+  markStartup("change directory");
+  if (!fastStart) {
+    bell();
+    markStartup("bell");
+  }
+}
+
+/// run what a fast start put off: the bell, and the list view if the config
+/// enables it.
+void Shell::finishStartup() {
+  _STARTUP_PENDING = false;
+  if (_LIST_VIEW_PENDING) {
+    _LIST_VIEW_PENDING = false;
+    _CURRENT_DIR = _HOME;
+    listView(1);
+  }
   bell();
 }
 
-/// load shell configuration variables from config.txt file
+/// note the end of a phase of startup on the timeline, if one is kept.
+void Shell::markStartup(char const *phase) {
+  if (_STARTUP != nullptr)
+    _STARTUP->mark(phase);
+}
+
+/// print the startup timeline kept since the shell was launched.
+void Shell::showStartupProfile() {
+  if (_STARTUP == nullptr)
+    return;
+  _DISPLAY->newLine();
+  for (auto const &line : _STARTUP->report()) {
+    _DISPLAY->write(line, A_DIM);
+    _DISPLAY->newLine();
+  }
+}
+
+/// apply the settings in config.txt, repainting once at the end.
 int Shell::initShellVariables() {
-  std::ifstream infile(_CONFIG_FILE);
-  std::string a, b;
-  while (infile >> a >> b) {
-    if (a == "!" || a.empty())
-      continue;
-    configure(a, b);
+  reportConfigErrors();
+
+  _DEFER_REPAINT = true;
+  _ARGV = {"configure", "", ""};
+  _ARGC = 3;
+  for (auto const &entry : _CONFIG.entries(ConfigFile::CONFIG)) {
+    _ARGV[1] = entry.key;
+    _ARGV[2] = entry.value;
+    Builtin const *const x = findConfigKey(_ARGV[1]);
+    if (x != nullptr) {
+      (this->*(x->run))(); // call using pointer
+    } else {
+      std::string message = _CONFIG_FILE.string() + ":" +
+                            std::to_string(entry.line) + ": shell variable " +
+                            _ARGV[1] + " is unrecognised.";
+      _DISPLAY->print(message, _STYLE_ERROR);
+      _DISPLAY->newLine();
+    }
   }
+  resetArgs();
+  _DEFER_REPAINT = false;
+
+  if (_REPAINT_PENDING)
+    repaint();
   return 0;
 }
 
+/// tell the user about lines of the settings files that could not be read.
+void Shell::reportConfigErrors() {
+  std::filesystem::path const *const paths[] = {
+      &_CONFIG_FILE, &_SHELL_ENV_FILE, &_SHORTCUTS_FILE};
+  for (auto const &error : _CONFIG.errors()) {
+    std::string message = paths[static_cast<size_t>(error.file)]->string() +
+                          ":" + std::to_string(error.line) + ": " +
+                          error.message;
+    _DISPLAY->print(message, _STYLE_ERROR);
+    _DISPLAY->newLine();
+  }
+}
+
 /// open text file with EDITOR environment variable
 int Shell::openWithTextEditor(std::string const &path) {
   char *editor = getenv("EDITOR");
@@ -469,32 +562,25 @@ int Shell::openWithTextEditor(std::string const &path) {
 
 /// load environment variables from environment.txt file
 int Shell::initEnvironmentVariables() {
-  std::ifstream infile(_SHELL_ENV_FILE);
-  std::string a, b;
-  while (infile >> a >> b) {
-    if (a == "!" || a.empty())
-      continue;
-    setenv(a.c_str(), b.c_str(), 1);
+  for (auto const &entry : _CONFIG.entries(ConfigFile::ENVIRONMENT)) {
+    std::string const name(entry.key);
+    std::string const value(entry.value);
+    setenv(name.c_str(), value.c_str(), 1);
   }
   return 0;
 }
 
-/// log last command and result to memory cache
+/// log last command to the history
 void Shell::logResult() {
-
-  // log last command to history file
-  appendTofile(_HISTORY_FILE, _LAST_COMMAND);
-
-  if (_COMMAND_HISTORY.size() == _MAX_MEMORY_HISTORY - 1)
-    _COMMAND_HISTORY.pop_front();
-
-  // add to virtual history buffer;
   if (!_LAST_COMMAND.empty() && _LAST_COMMAND != "memory")
-    _COMMAND_HISTORY.push_front(_LAST_COMMAND);
+    _HISTORY.append(_LAST_COMMAND);
 }
 
 /// print the prompt to the screen
 void Shell::displayPrompt() {
+  // merge in commands run meanwhile in other shells.
+  _HISTORY.sync();
+
   std::string currentDir = _CURRENT_DIR;
   std::string prompt = "Tr " + currentDir + "> ";
   _PROMPT_LEN = prompt.length();
@@ -524,11 +610,10 @@ int Shell::configure() {
 
   std::string argv1 = _ARGV[1];
 
-  command_map::const_iterator x;
-  x = _SHELL_CONFIG_MAP.find(argv1);
+  Builtin const *const x = findConfigKey(argv1);
 
-  if (x != _SHELL_CONFIG_MAP.end()) {
-    (this->*(x->second))(); // call using pointer
+  if (x != nullptr) {
+    (this->*(x->run))(); // call using pointer
     return 0;
   } else {
     std::string message = "Shell variable " + argv1 + " is unrecognised.";
@@ -580,11 +665,10 @@ int Shell::configure(std::string const &argv1, std::string const &argv2) {
   _ARGV.push_back(argv2);
   _ARGC = 3;
 
-  command_map::const_iterator x;
-  x = _SHELL_CONFIG_MAP.find(argv1);
+  Builtin const *const x = findConfigKey(argv1);
 
-  if (x != _SHELL_CONFIG_MAP.end()) {
-    (this->*(x->second))(); // call using pointer
+  if (x != nullptr) {
+    (this->*(x->run))(); // call using pointer
     return 0;
   } else {
     std::string message = "Shell variable " + argv1 + " is unrecognised.";
@@ -660,8 +744,8 @@ int Shell::configCursorColour() {
 
   // TODO: check if Background is the same colour and warn invisibility
 
-  printf("\e]12;%s\a", argv2.c_str());
-  fflush(stdout);
+  _CURSOR_COLOUR = argv2;
+  repaint();
   return 0;
 }
 
@@ -776,12 +860,8 @@ int Shell::configBackgroundColour() {
   }
 
   // TODO: check if Foreground is the same colour and warn invisibility/deny
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
-  _DISPLAY->refresh();
-
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
   _USING_COLOR_FLAG = 1;
+  repaint();
   return 0;
 }
 
@@ -831,12 +911,8 @@ int Shell::configForegroundColour() {
 
   start_color();
   // TODO: check if Foreground is the same colour and warn invisibility/deny
-  _DISPLAY->bgfg(_FOREGROUND, _BACKGROUND);
-  _DISPLAY->refresh();
-
-  printf("\e[%im\e[%im", _STD_FG, _STD_BG + 10);
-
   _USING_COLOR_FLAG = 1;
+  repaint();
   return 0;
 }
 
@@ -849,106 +925,213 @@ void Shell::resetArgs() {
 /// read in user arguments
 int Shell::readArgs() {
   noecho();
-  std::string line;
-  std::string userLine;
+  LineEditor editor;
+  std::string userLine;      // the line as typed, while browsing history
+  size_t historyCounter = 0; // commands back from the newest, 0 for userLine
 
-  char ch;
-  int memorySz = _COMMAND_HISTORY.size();
-  int historyCounter = 0;
+  _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
+  int const y = _CURSOR_Y;
+  size_t width = _DISPLAY_SIZE_X - 1 - _PROMPT_LEN;
+  size_t offset = 0; // first character shown; longer lines scroll sideways
+  size_t shown = 0;  // characters of the line on screen
+
+  // draw the visible part of the line from its first changed position,
+  // blanking what is left of a longer line, then place the cursor.
+  auto const redraw = [&]() {
+    size_t from = editor.dirtyFrom();
+    size_t const cursor = editor.cursor();
+    if (cursor < offset || cursor > offset + width) {
+      offset = cursor < offset ? cursor : cursor - width;
+      from = offset;
+    }
+    if (from != LineEditor::npos) {
+      size_t const begin = std::max(from, offset);
+      size_t const end = std::min(editor.size(), offset + width);
+      if (begin < end) {
+        _DISPLAY->moveCursor(y, _PROMPT_LEN + begin - offset);
+        _DISPLAY->write(editor.slice(begin, end));
+      }
+      size_t const visible = end > offset ? end - offset : 0;
+      if (shown > visible) {
+        _DISPLAY->moveCursor(y, _PROMPT_LEN + visible);
+        _DISPLAY->write(std::string(shown - visible, ' '));
+      }
+      shown = visible;
+      editor.markDrawn();
+    }
+    _DISPLAY->moveCursor(y, _PROMPT_LEN + cursor - offset);
+    _DISPLAY->refresh();
+  };
 
+  // keys are handled as they come, but the line is drawn only once every
+  // key waiting has been read, so a burst of input or a paste costs one
+  // frame. the terminal marks pastes, which are taken as text.
+  printf("\e[?2004h");
+  fflush(stdout);
+  bool draining = false;
+  bool pasting = false;
+  auto const block = [&]() {
+    draining = false;
+    _DISPLAY->setInputTimeout(-1);
+  };
+
+  // after a fast start, look for input without waiting so that the work put
+  // off is done as soon as the prompt is idle.
+  if (_STARTUP_PENDING)
+    _DISPLAY->setInputTimeout(0);
+
+  int ch;
+  bool escape = false; // ESC b and ESC f move by words
   do {
     ch = _DISPLAY->getCharFromUser();
-    if (ch == '\n') {
-      if (line.empty())
+    if (ch == ERR) {
+      // ^C abandons the line.
+      if (INTERRUPT_RECEIVED) {
+        INTERRUPT_RECEIVED = 0;
+        editor.clear();
+        historyCounter = 0;
+      }
+      // nothing more is waiting, or a paste has stalled.
+      pasting = false;
+      block();
+      if (_STARTUP_PENDING && editor.size() == 0) {
+        finishStartup();
+        width = _DISPLAY_SIZE_X - 1 - _PROMPT_LEN;
+        _DISPLAY->moveCursor(y, _PROMPT_LEN);
+      }
+      redraw();
+      continue;
+    }
+
+    if (ch == KEY_PASTE_BEGIN || ch == KEY_PASTE_END) {
+      pasting = ch == KEY_PASTE_BEGIN;
+      // wait for the rest of the paste rather than drawing part of it.
+      _DISPLAY->setInputTimeout(pasting ? 100 : 0);
+      draining = true;
+      continue;
+    }
+    if (pasting) {
+      // pasted lines and tabs become spaces; other controls are dropped.
+      if (ch == '\n' || ch == '\r' || ch == '\t')
+        ch = ' ';
+      if (ch >= ' ' && ch < 256 && ch != 127)
+        editor.insert((char)ch);
+      continue;
+    }
+
+    bool const escaped = escape;
+    escape = false;
+    if (escaped && ch == 'b') {
+      editor.wordLeft();
+    } else if (escaped && ch == 'f') {
+      editor.wordRight();
+    } else if (ch == '\n' || ch == KEY_ENTER) {
+      if (editor.size() == 0)
         bell();
       else
         break;
-    } else if ((_DELETE > 0 && (int)ch == _DELETE) || (int)ch == 8 ||
-               (int)ch == KEY_BACKSPACE || (int)ch == KEY_DC ||
-               (int)ch == 127) {
-      _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
-      if (_CURSOR_X > _PROMPT_LEN) {
-        _DISPLAY->print("\b");
-        _DISPLAY->deleteChar();
-        _DISPLAY->refresh();
-      }
-      if (!line.empty()) {
-        line.pop_back();
+    } else if ((_DELETE > 0 && ch == _DELETE) || ch == 8 ||
+               ch == KEY_BACKSPACE || ch == 127) {
+      editor.backspace();
+    } else if (ch == KEY_DC || ch == 4 /*^D*/) {
+      editor.deleteForward();
+    } else if (ch == KEY_LEFT || ch == 2 /*^B*/) {
+      editor.left();
+    } else if (ch == KEY_RIGHT || ch == 6 /*^F*/) {
+      editor.right();
+    } else if (ch == KEY_HOME || ch == 1 /*^A*/) {
+      editor.home();
+    } else if (ch == KEY_END || ch == 5 /*^E*/) {
+      editor.end();
+    } else if (ch == 23 /*^W*/) {
+      editor.deleteWordBefore();
+    } else if (ch == 21 /*^U*/) {
+      editor.killToStart();
+    } else if (ch == 11 /*^K*/) {
+      editor.killToEnd();
+    } else if (ch == 27 /*ESC*/) {
+      escape = true;
+    } else if (ch == KEY_UP || ch == 16 /*^P*/) {
+      if (historyCounter < _HISTORY.size()) {
+        if (historyCounter == 0)
+          userLine = editor.text();
+        historyCounter++;
+        editor.assign(_HISTORY.entry(_HISTORY.size() - historyCounter));
       }
-    } else if ((int)ch == 27 || (int)ch == KEY_UP || (int)ch == 3) {
-      if (!_COMMAND_HISTORY.empty()) {
-        if (historyCounter + 1 < memorySz) {
-          historyCounter++;
-          _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
-          std::string fromMemory = _COMMAND_HISTORY[historyCounter];
-          _DISPLAY->erase(_CURSOR_Y, _PROMPT_LEN, _CURSOR_Y, _TERM_SIZE_X - 1);
-          _DISPLAY->insert(fromMemory, _CURSOR_Y, _PROMPT_LEN);
-
-          line = fromMemory;
-
-          _DISPLAY->refresh();
-        }
-      }
-    } else if ((int)ch == KEY_LEFT || (int)ch == 4) {
-      _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
-      if (_CURSOR_X > _PROMPT_LEN) {
-        _DISPLAY->print("\b");
-        _DISPLAY->refresh();
-      }
-    } else if ((int)ch == KEY_RIGHT || (int)ch == 5) {
-      _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
-      if (_CURSOR_X < _DISPLAY_SIZE_X) {
-        move(_CURSOR_Y, _CURSOR_X + 1);
-        _DISPLAY->refresh();
-      }
-    } else if ((int)ch == KEY_DOWN || (int)ch == 2) {
-      if (!_COMMAND_HISTORY.empty()) {
-        _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
-
-        if (historyCounter > 0) {
-          historyCounter--;
-          std::string fromMemory = _COMMAND_HISTORY[historyCounter];
-          _DISPLAY->erase(_CURSOR_Y, _PROMPT_LEN, _CURSOR_Y, _TERM_SIZE_X - 1);
-          _DISPLAY->insert(fromMemory, _CURSOR_Y, _PROMPT_LEN);
-
-          line = fromMemory;
-
-          _DISPLAY->refresh();
-        } else if (historyCounter <= 0) {
-          historyCounter = 0;
-          _DISPLAY->erase(_CURSOR_Y, _PROMPT_LEN + 2, _CURSOR_Y,
-                          _DISPLAY_SIZE_X - 1);
-          _DISPLAY->insert(userLine, _CURSOR_Y, _PROMPT_LEN);
-
-          line = userLine;
-          _DISPLAY->refresh();
-        }
-      }
-    } else {
-      _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
-      if (_CURSOR_X < _DISPLAY_SIZE_X - 1) {
-        _DISPLAY->addChar(ch);
-        line += ch;
-        userLine = line;
+    } else if (ch == KEY_DOWN || ch == 14 /*^N*/) {
+      if (historyCounter > 0) {
+        historyCounter--;
+        if (historyCounter > 0)
+          editor.assign(_HISTORY.entry(_HISTORY.size() - historyCounter));
+        else
+          editor.assign(userLine);
       }
+    } else if (ch == 9 /*TAB*/) {
+      // complete the word before the cursor.
+      block();
+      redraw();
+      std::string before = editor.slice(0, editor.cursor());
+      std::string const after = editor.slice(editor.cursor(), editor.size());
+      completeLine(before);
+      editor.assign(before + after);
+      editor.moveTo(before.size());
+    } else if (ch == 18 /*^R*/) {
+      block();
+      redraw();
+      std::string line = editor.text();
+      bool const run = reverseSearch(line);
+      editor.assign(line);
+      editor.invalidate(offset);
+      shown = width;
+      if (run)
+        break;
+    } else if (ch >= ' ' && ch < 256) {
+      editor.insert((char)ch);
+    }
+
+    if (!draining) {
+      draining = true;
+      _DISPLAY->setInputTimeout(0);
     }
   } while (1);
 
+  block();
+  editor.end();
+  redraw();
+  printf("\e[?2004l");
+  fflush(stdout);
+
+  std::string const line = editor.text();
+
   // store last command entered.
   _LAST_COMMAND = line;
 
-  // tokenize the string
-  std::stringstream ss(line);
-  std::string item;
+  if (_LEXER.lex(line) != 0) {
+    _DISPLAY->newLine();
+    _DISPLAY->write(std::string("syntax error: ") + _LEXER.error(),
+                    _STYLE_ERROR);
+    _DISPLAY->newLine();
+    _ARGC = 0;
+    return 0;
+  }
 
-  while (std::getline(ss, item, ' '))
-    _ARGV.push_back(item);
+  if (_LEXER.hasOperators()) {
+    // pipelines and redirections are run by the user's shell.
+    _ARGV = {_SHELL, "-c", line};
+  } else {
+    char *const *argv = _LEXER.argv();
+    for (size_t i = 0; i < _LEXER.argc(); ++i)
+      _ARGV.emplace_back(argv[i]);
+  }
   _ARGC = _ARGV.size();
+  if (_ARGC == 0 && !line.empty())
+    _DISPLAY->newLine();
 
   return 0;
 }
 
 void Shell::displayListView(std::filesystem::path const &dir) {
+  _LSVIEW_PENDING = false; // shown now, whatever was waiting
 
   _LSVIEW_SIZE_Y = _TERM_SIZE_Y;
   _LSVIEW_SIZE_X = _TERM_SIZE_X / 4;
@@ -970,66 +1153,141 @@ void Shell::displayListView(std::filesystem::path const &dir) {
   if (_SHOW_BORDER)
     _LSVIEW->borderStyle();
 
-  PathController path;
-  path.showHidden(_LIST_VIEW_HIDDEN_ENABLED);
-  path.loadParent(dir);
-  auto const children = path.children();
+  size_t const height = _LSVIEW_SIZE_Y - 4;
+  ListViewPreview const &preview = listViewPreview(dir, height);
 
-  int childrenSize = children.size();
   _LSVIEW->eraseWin();
   _LSVIEW->refresh();
   _LSVIEW->print("contents in ");
   _LSVIEW->print(dir, A_BOLD);
   _LSVIEW->newLines(2);
 
-  int height = _LSVIEW_SIZE_Y - 4;
-  if (childrenSize > height) {
-    int remaining = childrenSize - height;
-    for (int i = 0; i < height; i++) {
-      auto const &child = children[i];
-      std::string entity = child.filename();
-      attr_t style;
-      auto const type = path.pathType(child);
-      if (type == "directory")
-        style = A_BOLD;
-      else if (type == "file")
-        style = A_NORMAL;
-      else
-        style = A_DIM;
-      _LSVIEW->print(child.filename(), style);
-      _LSVIEW->newLine();
-    }
+  for (auto const &line : preview.lines) {
+    attr_t style;
+    if (line.second == PathType::DIRECTORY)
+      style = A_BOLD;
+    else if (line.second == PathType::FILE)
+      style = A_NORMAL;
+    else
+      style = A_DIM;
+    _LSVIEW->print(line.first, style);
+    _LSVIEW->newLine();
+  }
+  if (preview.total > height) {
+    size_t remaining = preview.total - height;
     _LSVIEW->newLines(2);
     std::string message = "+ " + std::to_string(remaining) + " remaining...";
     _LSVIEW->print(message);
-  } else {
-    for (auto const &child : children) {
-      attr_t style;
-      auto const type = path.pathType(child);
-      if (type == "directory")
-        style = A_BOLD;
-      else if (type == "file")
-        style = A_NORMAL;
-      else
-        style = A_DIM;
-      _LSVIEW->print(child.filename(), style);
-      _LSVIEW->newLine();
-    }
   }
   _LSVIEW->refresh();
 }
 
+/// the first height children of dir as the list view shows them, made
+/// again only if the listing of dir has changed since.
+ListViewPreview const &Shell::listViewPreview(std::filesystem::path const &dir,
+                                              size_t const height) {
+  ListViewPreview const *cached =
+      _PREVIEW_CACHE.find(dir, _DIRECTORY_CACHE.cached(dir),
+                          _LIST_VIEW_HIDDEN_ENABLED, _SORT_ORDER, height);
+  if (cached != nullptr)
+    return *cached;
+
+  PathController path(&_DIRECTORY_CACHE);
+  path.showHidden(_LIST_VIEW_HIDDEN_ENABLED);
+  path.sortBy(_SORT_ORDER);
+  path.loadParent(dir);
+
+  // only the names and types are shown, which reading the directory gives
+  // without a stat for most entries.
+  ListViewPreview preview;
+  preview.total = path.childrenSize();
+  preview.hidden = _LIST_VIEW_HIDDEN_ENABLED;
+  preview.order = _SORT_ORDER;
+  preview.height = height;
+  preview.listing = _DIRECTORY_CACHE.cached(dir);
+  size_t const shown = std::min(preview.total, height);
+  for (size_t i = 0; i < shown; i++)
+    preview.lines.emplace_back(std::string(path.name(i)), path.type(i));
+  return _PREVIEW_CACHE.store(dir, std::move(preview));
+}
+
+/// show dir in the list view once the highlight has rested on it, or that
+/// the highlight is not on a directory if dir is empty. asking again for
+/// the one waiting leaves it waiting no longer. until it is shown,
+/// updateListView() must be called whenever input is waited on.
+void Shell::previewListView(std::filesystem::path const &dir) {
+  if (_LSVIEW_PENDING && dir == _LSVIEW_PENDING_DIR)
+    return;
+  _LSVIEW_PENDING = true;
+  _LSVIEW_FETCHING = false;
+  _LSVIEW_PENDING_DIR = dir;
+  _LSVIEW_DUE = std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(_PREVIEW_DELAY_MS);
+}
+
+/// move the preview waiting along: once it is due, its directory is read
+/// on the prefetcher's threads, and shown once it has been read. returns
+/// how long to wait for input before calling again, or -1 if nothing is
+/// waiting.
+int Shell::updateListView() {
+  if (!_LSVIEW_PENDING)
+    return -1;
+  auto const now = std::chrono::steady_clock::now();
+  if (now < _LSVIEW_DUE)
+    return std::chrono::ceil<std::chrono::milliseconds>(_LSVIEW_DUE - now)
+        .count();
+
+  if (_LSVIEW_PENDING_DIR.empty()) {
+    _LSVIEW_PENDING = false;
+    _LSVIEW->eraseWin();
+    _LSVIEW->print("not a directory!");
+    _LSVIEW->refresh();
+    return -1;
+  }
+
+  DirectoryPrefetcher &prefetcher = directoryPrefetcher();
+  prefetcher.collect();
+  bool const ready = _DIRECTORY_CACHE.cached(_LSVIEW_PENDING_DIR) != nullptr;
+  if (!ready && !_LSVIEW_FETCHING) {
+    // navigateDir may be reading it already, with its neighbours.
+    if (!prefetcher.wanted(_LSVIEW_PENDING_DIR))
+      prefetcher.prefetch({_LSVIEW_PENDING_DIR}, _SORT_ORDER);
+    _LSVIEW_FETCHING = true;
+  }
+  if (!ready && prefetcher.wanted(_LSVIEW_PENDING_DIR))
+    return _LOADING_POLL_MS;
+
+  // read, or not to be read ahead: a directory too large to prefetch, or
+  // one that cannot be watched, is read here.
+  try {
+    displayListView(_LSVIEW_PENDING_DIR);
+  } catch (std::filesystem::filesystem_error &e) {
+    _LSVIEW_PENDING = false;
+    _LSVIEW->eraseWin();
+    _LSVIEW->print(e.what());
+    _LSVIEW->refresh();
+  }
+  return -1;
+}
+
+/// the threads reading directories ahead, started when first wanted.
+DirectoryPrefetcher &Shell::directoryPrefetcher() {
+  if (!_PREFETCHER)
+    _PREFETCHER = std::make_unique<DirectoryPrefetcher>(_DIRECTORY_CACHE);
+  return *_PREFETCHER;
+}
+
 /// returns _ARGV
 std::vector<std::string> Shell::argv() const { return _ARGV; }
 
-/// print to screen the virutal memory history
+/// print to screen the most recent commands in the history
 int Shell::printMemoryHistory() {
-  if (!_COMMAND_HISTORY.empty()) {
-    for (std::deque<std::string>::const_iterator command =
-             _COMMAND_HISTORY.end();
-         command != _COMMAND_HISTORY.begin(); command--) {
-      _DISPLAY->print("%s\n", command->c_str());
-    }
+  size_t const count = _HISTORY.size();
+  size_t const first =
+      count > _MAX_MEMORY_HISTORY ? count - _MAX_MEMORY_HISTORY : 0;
+  for (size_t i = first; i < count; ++i) {
+    _DISPLAY->write(std::string(_HISTORY.entry(i)));
+    _DISPLAY->newLine();
   }
   return 0;
 }
@@ -1045,12 +1303,27 @@ int Shell::MOVE() {
 /// attempt to execute natively
 int Shell::execute() {
 
-  command_map::const_iterator x;
-  x = _COMMAND_MAP.find(_ARGV[0]);
+  Builtin const *const x = findBuiltin(_ARGV[0]);
 
-  if (x != _COMMAND_MAP.end()) {
+  if (x != nullptr && x->run != nullptr) {
     _DISPLAY->newLine();
-    (this->*(x->second))(); // call using pointer
+    if (_ARGC < x->minArgs || _ARGC > x->maxArgs) {
+      int const least = x->minArgs - 1;
+      int const most = x->maxArgs - 1;
+      std::string message = _ARGV[0] + ": takes ";
+      if (least == most)
+        message += std::to_string(least);
+      else if (x->maxArgs == UINT8_MAX)
+        message += "at least " + std::to_string(least);
+      else
+        message += std::to_string(least) + " to " + std::to_string(most);
+      bool const single = least == 1 && (most == 1 || x->maxArgs == UINT8_MAX);
+      message += single ? " argument." : " arguments.";
+      _DISPLAY->print(message, _STYLE_ERROR);
+      _DISPLAY->newLine();
+      return 0;
+    }
+    (this->*(x->run))(); // call using pointer
     return 0;
   } else {
     return 1;
@@ -1058,82 +1331,356 @@ int Shell::execute() {
 }
 
 bool Shell::commandNotPrintable() {
-  std::vector<std::string>::const_iterator x;
-  x = std::find(_PRINTABLES.begin(), _PRINTABLES.end(), _ARGV[0]);
-  return x == _PRINTABLES.end();
+  Builtin const *const x = findBuiltin(_ARGV[0]);
+  return x == nullptr || !x->captured;
 }
 
-void Shell::runCommand() {
+/// draw one frame of captured output. lines that were skipped to keep up
+/// are only noted; they can still be read with the scrollback command.
+void Shell::renderOutput(std::deque<std::string> const &lines,
+                         size_t skipped) {
+  if (skipped > 0) {
+    std::string message =
+        "... " + std::to_string(skipped) + " lines skipped (see scrollback)";
+    _DISPLAY->write(message, A_DIM);
+    _DISPLAY->write("\n");
+  }
+  for (auto const &line : lines) {
+    _ANSI_TEXT.write(*_DISPLAY, line);
+    _DISPLAY->write("\n");
+  }
+  _DISPLAY->refresh();
+}
 
-  if (execute() != 0) {
+/// colours in command output that are left as the default are drawn in the
+/// theme colours.
+void Shell::useThemeColours() {
+  if (_USING_COLOR_FLAG)
+    _COLOUR_PAIRS.setDefault(_FOREGROUND, _BACKGROUND);
+  else
+    _COLOUR_PAIRS.setDefault(-1, -1);
+}
 
-    tcgetattr(STDIN_FILENO, &_OLDT); /*store old settings */
-   // _NEWT = _OLDT;                   /* copy old settings to new settings */
-   // _NEWT.c_oflag |= (ONLCR | ECHO);
-   // _NEWT.c_lflag &= ~(ICANON); /* make one change to old
-   //                  settings in new settings */
-   //                                    //  tcsetattr(STDIN_FILENO, TCSANOW,
-   //            &_NEWT); /*apply the new settings immediatly */
+/// run a job on a pseudo-terminal and draw what it writes into the display,
+/// so full-screen and coloured programs work inside the shell pane. keys are
+/// passed to the program untranslated, so ^C and ^Z reach it through the
+/// pseudo-terminal. returns when the job ends or stops, or -1 if the
+/// pseudo-terminal could not be opened.
+int Shell::runInTerminal(Job &job) {
+  if (job.terminal == nullptr) {
+    job.pty = std::make_unique<PtySession>();
+    if (job.pty->spawn(job.exec, _DISPLAY_SIZE_Y, _DISPLAY_SIZE_X) != 0) {
+      job.pty.reset();
+      return -1;
+    }
+    job.pid = job.pgid = job.pty->pid();
+    job.pty->release();
+    job.terminal = std::make_unique<DisplayKernel::Terminal>(_DISPLAY_SIZE_Y,
+                                                             _DISPLAY_SIZE_X);
+    _DISPLAY->newLine();
+  }
+
+  // a program on the main screen carries on below the prompt.
+  DisplayKernel::Terminal &terminal = *job.terminal;
+  if (!terminal.altScreen()) {
+    _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
+    terminal.setCursor(_CURSOR_Y, 0);
+  }
+  useThemeColours();
+
+  raw();
+  _DISPLAY->setKeypad(false);
+  if (job.state == JobState::STOPPED)
+    job.resume();
+
+  using clock = std::chrono::steady_clock;
+  auto const frame = std::chrono::milliseconds(1000 / _FRAME_RATE);
+  auto nextFrame = clock::now();
+  bool pending = false; // output fed but not drawn yet
+  std::vector<char> buffer(1 << 16);
+
+  auto const draw = [&]() {
+    terminal.render(*_DISPLAY, _COLOUR_PAIRS);
+    curs_set(terminal.cursorVisible() ? _CURSOR : 0);
+    pending = false;
+    nextFrame = clock::now() + frame;
+  };
+
+  // feed the terminal what the program has written, answering any queries
+  // it made of the terminal.
+  auto const readPty = [&]() {
+    ssize_t const got = job.pty->read(buffer.data(), buffer.size());
+    if (got > 0) {
+      terminal.feed(buffer.data(), got);
+      std::string const response = terminal.takeResponse();
+      if (!response.empty())
+        job.pty->write(response.data(), response.size());
+      pending = true;
+    }
+    return got;
+  };
+
+  while (true) {
+    // SIGCHLD interrupts poll; the timeout only guards against missing it.
+    int timeout = 100;
+    if (pending) {
+      auto const wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+          nextFrame - clock::now());
+      timeout = std::max<long>(0, std::min<long>(timeout, wait.count()));
+    }
+
+    // keys the program has not read yet are sent once it has room for them.
+    short const ptyEvents = job.pty->hasUnsent() ? POLLIN | POLLOUT : POLLIN;
+    struct pollfd fds[2] = {{job.pty->fd(), ptyEvents, 0},
+                            {STDIN_FILENO, POLLIN, 0}};
+    int const ready = poll(fds, 2, timeout);
+    if (ready < 0 && errno != EINTR)
+      break;
+
+    if (fds[0].revents & POLLOUT)
+      job.pty->flush();
+
+    if (fds[1].revents & POLLIN) {
+      ssize_t got = read(STDIN_FILENO, buffer.data(), buffer.size());
+      // the program leads a session of its own, so the kernel would discard
+      // the SIGTSTP its terminal sends for ^Z. the shell stops it instead.
+      int const suspend = job.pty->suspendChar();
+      char const *suspendAt = nullptr;
+      if (got > 0 && suspend >= 0)
+        suspendAt = static_cast<char const *>(
+            memchr(buffer.data(), suspend, got));
+      if (suspendAt != nullptr)
+        got = suspendAt - buffer.data();
+      if (got > 0)
+        job.pty->write(buffer.data(), got);
+      if (suspendAt != nullptr) {
+        job.suspend(100);
+        if (job.state == JobState::STOPPED)
+          break;
+      }
+    }
+
+    if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      ssize_t const got = readPty();
+      if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR))
+        break; // EIO once the program and its children have exited
+    }
+
+    if (CHILD_CHANGED || ready == 0) {
+      CHILD_CHANGED = 0;
+      JobState const state = job.update();
+      if (state == JobState::STOPPED)
+        break;
+      if (state == JobState::DONE) {
+        // children left running in the background can keep the terminal
+        // open; take what is already written and stop waiting for EIO.
+        struct pollfd fd = {job.pty->fd(), POLLIN, 0};
+        while (poll(&fd, 1, 0) > 0 && (fd.revents & POLLIN) && readPty() > 0)
+          ;
+        break;
+      }
+    }
+
+    if (pending && clock::now() >= nextFrame)
+      draw();
+  }
+  draw();
+
+  if (job.state == JobState::STOPPED) {
+    terminal.detach(*_DISPLAY);
+  } else {
+    // the terminal is closed; anything still holding it open is cut off.
+    job.pty.reset();
+    job.reap(100);
+  }
+
+  noraw();
+  cbreak();
+  _DISPLAY->setKeypad(true);
+  curs_set(_CURSOR);
+  _DISPLAY->cursorPosition(_CURSOR_Y, _CURSOR_X);
+  if (_CURSOR_X != 0)
+    _DISPLAY->write("\n");
+  _DISPLAY->refresh();
+  return 0;
+}
+
+/// run a job with its stdout and stderr captured, polling both so a child
+/// that fills one pipe cannot stall while the other is being read. output is
+/// drawn at most _FRAME_RATE times a second. ^C and ^Z reach the shell, which
+/// passes them on to the job's process group; an interrupted job is not
+/// waited on to empty its pipes.
+int Shell::runCaptured(Job &job) {
+  if (job.capture == nullptr) {
+    job.capture = std::make_unique<CommandCapture>();
+    if (job.capture->spawn(job.exec) != 0) {
+      job.capture.reset();
+      return -1;
+    }
+    job.pid = job.pgid = job.capture->pid();
+    job.capture->release();
+    _ANSI_TEXT.reset();
+  }
+  useThemeColours();
+  if (job.state == JobState::STOPPED)
+    job.resume();
+
+  OutputPipeline pipeline(_SCROLLBACK, _MAX_SCROLLBACK, _DISPLAY_SIZE_Y,
+                          _FRAME_RATE);
+  auto const onLine = [&pipeline](CaptureStream, std::string const &line) {
+    pipeline.push(line);
+  };
+  auto const onFrame = [this](std::deque<std::string> const &lines,
+                              size_t skipped) {
+    renderOutput(lines, skipped);
+  };
+
+  bool interrupted = false;
+  bool suspended = false;
+  auto const signalled = [&]() {
+    interrupted = INTERRUPT_RECEIVED;
+    suspended = !interrupted && SUSPEND_RECEIVED;
+    return interrupted || suspended;
+  };
+  while (job.capture->pump(pipeline.msUntilFrame(), onLine)) {
+    if (signalled())
+      break;
+    if (pipeline.due())
+      pipeline.render(onFrame);
+  }
+
+  // a job can close or redirect its output and carry on running. it is
+  // waited for in short steps so that ^C and ^Z still reach it.
+  if (!interrupted && !suspended) {
+    pipeline.render(onFrame);
+    while (job.update() == JobState::RUNNING && !signalled())
+      usleep(10000);
+  }
+  INTERRUPT_RECEIVED = 0;
+  SUSPEND_RECEIVED = 0;
+
+  if (interrupted) {
+    job.signal(SIGINT);
+    pipeline.discard();
+    pipeline.render(onFrame);
+    job.capture->close();
+    job.reap(50);
+    return 0;
+  }
+
+  pipeline.render(onFrame);
+  if (suspended)
+    job.suspend(100);
+  return 0;
+}
+
+/// hand the real terminal to a job and wait until it ends or stops. used
+/// when no pseudo-terminal can be opened.
+int Shell::runWithTerminal(Job &job) {
+  if (job.pid <= 0) {
     system("stty sane");
 
-    // fallback to bash/sh
-    if (commandNotPrintable()) {
+    char *const *command = job.exec;
+    pid_t pid = fork();
 
-      int result;
-      pid_t pid = fork();
+    // error
+    if (pid < 0) {
+      perror("Error (pid < 0)");
+      return -1;
+    }
 
-      std::vector<char *> argv = nullTerminatedArgV(_ARGV);
-      char **command = argv.data();
+    // child process
+    if (pid == 0) {
+      setpgid(0, 0);
+      tcsetpgrp(STDIN_FILENO, getpid());
+      for (int sig : {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGCHLD})
+        signal(sig, SIG_DFL);
+
+      std::cout << "\n";
+      char cmd[100];
+      strcpy(cmd, "/usr/bin/");
+      strcat(cmd, command[0]);
+      int result = execvp(command[0][0] == '/' ? command[0] : cmd, command);
+      perror("Fallback Shell");
+
+      exit(RESULT::END_OF_PROCESS);
+    }
 
-      // error
-      if (pid < 0)
-        perror("Error (pid < 0)");
+    setpgid(pid, pid);
+    job.pid = job.pgid = pid;
+  }
 
-      // child process
-      else if (pid == 0) {
+  // ^C and ^Z from the terminal go straight to the job's process group.
+  tcsetpgrp(STDIN_FILENO, job.pgid);
+  if (job.state == JobState::STOPPED)
+    job.resume();
+  while (job.update(true) == JobState::RUNNING)
+    ;
+  tcsetpgrp(STDIN_FILENO, getpgrp());
 
-        std::cout << "\n";
-        char cmd[100];
-        strcpy(cmd, "/usr/bin/");
-        strcat(cmd, command[0]);
-        int result = execvp(cmd, command);
-        perror("Fallback Shell");
+  // do parental things
+  _DISPLAY->newLine();
+  return 0;
+}
 
-        exit(RESULT::END_OF_PROCESS);
+/// run job in the foreground until it ends or stops. a stopped job is kept
+/// for fg.
+void Shell::foregroundJob(Job &job) {
+  INTERRUPT_RECEIVED = 0;
+  SUSPEND_RECEIVED = 0;
+
+  if (job.capture != nullptr) {
+    runCaptured(job);
+  } else if (job.pty != nullptr) {
+    runInTerminal(job);
+    bell();
+  } else if (job.pid > 0) {
+    runWithTerminal(job);
+    bell();
+  } else if (commandNotPrintable()) {
+    // programs run on a pseudo-terminal drawn into the display. the real
+    // terminal is only handed over if a pseudo-terminal cannot be opened.
+    if (runInTerminal(job) != 0)
+      runWithTerminal(job);
+    bell();
+  } else {
+    _DISPLAY->newLine();
+    runCaptured(job);
+  }
 
-      } else if (pid > 0) {
-        waitpid(pid, NULL, 0);
-        // do parental things
-        _DISPLAY->newLine();
-        bell();
-      }
+  if (job.state == JobState::STOPPED) {
+    _JOBS.push_back(std::move(job));
+    std::string message = "[" + std::to_string(_JOBS.size()) + "] stopped  " +
+                          _JOBS.back().commandLine();
+    _DISPLAY->write(message, A_DIM);
+    _DISPLAY->newLine();
+  }
+}
 
-    } else {
-      _DISPLAY->newLine();
-      // run a process and create a streambuf that reads its stdout and stderr
-      redi::ipstream proc(_ARGV,
-                          redi::pstreams::pstdout | redi::pstreams::pstderr);
-      std::string line;
-      // read child's stdout
-      while (std::getline(proc.out(), line)) {
-        // the output is captured line by line here
-        // so that i can do what i want with it
-        _DISPLAY->print(line.c_str());
-        _DISPLAY->newLine();
-      }
+void Shell::runCommand() {
 
-      // if reading stdout stopped at EOF then reset the state:
-      if (proc.eof() && proc.fail()) {
-        proc.clear();
-      }
-      // read child's stderr
-      while (std::getline(proc.err(), line)) {
-        // error message is captured line by line here
-        // so that i can do what i want with it.
-        _DISPLAY->print(line.c_str());
-        _DISPLAY->newLine();
-      }
+  if (execute() != 0) {
+
+    tcgetattr(STDIN_FILENO, &_OLDT); /*store old settings */
+   // _NEWT = _OLDT;                   /* copy old settings to new settings */
+   // _NEWT.c_oflag |= (ONLCR | ECHO);
+   // _NEWT.c_lflag &= ~(ICANON); /* make one change to old
+   //                  settings in new settings */
+   //                                    //  tcsetattr(STDIN_FILENO, TCSANOW,
+   //            &_NEWT); /*apply the new settings immediatly */
+
+    Job job;
+    job.argv = _ARGV;
+    // words come straight from the lexer's arena; only a line handed to the
+    // user's shell needs an argv built for it.
+    std::vector<char *> shellArgv;
+    if (_LEXER.hasOperators()) {
+      shellArgv = nullTerminatedArgV(job.argv);
+      job.exec = shellArgv.data();
+    } else {
+      job.exec = _LEXER.argv();
     }
+    foregroundJob(job);
     tcsetattr(STDIN_FILENO, TCSANOW, &_OLDT);
   }
 }
@@ -1208,7 +1755,7 @@ int Shell::listView(bool x) {
   return 0;
 }
 
-Shell::Shell() {
+Shell::Shell(StartupProfiler *startup) : _STARTUP(startup) {
   // required environment variables
   char *path = getenv("PATH");
   char *term = getenv("TERM");
@@ -1241,11 +1788,19 @@ Shell::Shell() {
   _SHELL_ENV_FILE = _HOME + "/.tr/environment.txt";
   _SHORTCUTS_FILE = _HOME + "/.tr/shortcuts.txt";
   _HISTORY_FILE = _HOME + "/.tr/history.txt";
+  _DIRECTORY_RANK_FILE = _HOME + "/.tr/directories.rank";
+  _CONFIG_CACHE_FILE = _HOME + "/.tr/config.cache";
 
-  // refresh history on startup
-  std::ofstream outfile;
-  outfile.open(_HISTORY_FILE, std::ios_base::trunc);
-  outfile.close();
+  // settings are applied once the display is up, in loadShell.
+  _CONFIG.open({_CONFIG_FILE, _SHELL_ENV_FILE, _SHORTCUTS_FILE},
+               _CONFIG_CACHE_FILE);
+  markStartup(_CONFIG.fromCache() ? "read settings (cached)"
+                                  : "read settings files");
+
+  // history is kept across sessions; without it the shell still runs.
+  _HISTORY.open(_HISTORY_FILE);
+  _DIRECTORY_RANK.open(_DIRECTORY_RANK_FILE);
+  markStartup("open history");
 
   auto const termSz = DisplayKernel::TERMINAL_SIZE();
 
@@ -1260,15 +1815,36 @@ Shell::Shell() {
 
   // SIGINT may end process without exiting Shell
   // std::string test = "test";
-  auto signalHandler = [](int const i) {};
+  auto signalHandler = [](int const i) { INTERRUPT_RECEIVED = 1; };
 
   _SIGNAL_INT_HANDLER.sa_handler = signalHandler;
   sigemptyset(&_SIGNAL_INT_HANDLER.sa_mask);
   _SIGNAL_INT_HANDLER.sa_flags = 0;
   sigaction(SIGINT, &_SIGNAL_INT_HANDLER, NULL);
+
+  // ^Z suspends the foreground job, never the shell. installed before curses
+  // starts so that it does not set up its own handler.
+  _SIGNAL_TSTP_HANDLER.sa_handler = [](int const) { SUSPEND_RECEIVED = 1; };
+  sigemptyset(&_SIGNAL_TSTP_HANDLER.sa_mask);
+  _SIGNAL_TSTP_HANDLER.sa_flags = SA_RESTART;
+  sigaction(SIGTSTP, &_SIGNAL_TSTP_HANDLER, NULL);
+
+  // wakes loops waiting on a job when it exits or stops.
+  _SIGNAL_CHLD_HANDLER.sa_handler = [](int const) { CHILD_CHANGED = 1; };
+  sigemptyset(&_SIGNAL_CHLD_HANDLER.sa_mask);
+  _SIGNAL_CHLD_HANDLER.sa_flags = SA_RESTART;
+  sigaction(SIGCHLD, &_SIGNAL_CHLD_HANDLER, NULL);
+
+  // the shell takes the terminal back from a job while in the background.
+  signal(SIGTTOU, SIG_IGN);
 }
 
 Shell::~Shell() {
+  // stopped jobs would otherwise be left stopped forever.
+  for (auto const &job : _JOBS) {
+    job.signal(SIGHUP);
+    job.signal(SIGCONT);
+  }
   _DISPLAY->setWin(BlackOS::DisplayKernel::WIN_SET_CODE::KILL_PARENT);
   std::cout << "\nexited Tr.\n";
 }
@@ -59,11 +59,13 @@ int Shell::shortcut() {
   size_t maxNameLen = 0;
   size_t maxDirLen = 0;
 
-  std::ifstream infile(_SHORTCUTS_FILE);
-  std::string shortcutName, directory;
+  // shortcuts.txt may have been edited since it was last read.
+  _CONFIG.reload();
   std::vector<std::string> shortcutNames, directories, fields;
 
-  while (infile >> shortcutName >> directory) {
+  for (auto const &entry : _CONFIG.entries(ConfigFile::SHORTCUTS)) {
+    std::string const shortcutName(entry.key);
+    std::string const directory(entry.value);
     shortcutNames.push_back(shortcutName);
     directories.push_back(directory);
 
@@ -73,6 +75,20 @@ int Shell::shortcut() {
       maxDirLen = directory.length();
   }
 
+  // shortcuts stay pinned at the top; visited directories follow, best
+  // ranked first, with their score in place of a name.
+  size_t const pinned = directories.size();
+  for (auto const &candidate : _DIRECTORY_RANK.ranked()) {
+    auto const pinnedEnd = directories.begin() + pinned;
+    if (std::find(directories.begin(), pinnedEnd, candidate.first) !=
+        pinnedEnd)
+      continue;
+    shortcutNames.push_back(fmt::format("{:.1f}", candidate.second));
+    directories.push_back(candidate.first);
+    if (maxDirLen < candidate.first.length())
+      maxDirLen = candidate.first.length();
+  }
+
   if (maxNameLen > 8 /*length of 'shortcut'*/)
     maxNameLen += 3;
   else
@@ -133,22 +149,17 @@ int Shell::shortcut() {
   ShortcutMenu.resetHighlighted();
   ShortcutMenu.setKeypad(true);
 
-  // initial LSVIEW window
-  if (_LIST_VIEW_ENABLED) {
-    auto listViewPath = directories[ShortcutMenu.highlighted()];
-    try {
-      displayListView(listViewPath);
-    } catch (std::filesystem::filesystem_error &e) {
-      _LSVIEW->eraseWin();
-      _LSVIEW->print(e.what());
-      _LSVIEW->refresh();
-    }
-  }
+  // the list view follows the highlight once it rests on a directory.
+  if (_LIST_VIEW_ENABLED)
+    previewListView(directories[ShortcutMenu.selectedFieldIndex()]);
 
   while (true) {
 
     ShortcutMenu.loadFields();
+    ShortcutMenu.setInputTimeout(updateListView());
     selection = ShortcutMenu.getCharFromUser(); // calls refresh implicitly
+    if (selection == ERR)
+      continue; // a preview is due
     currentPage = ShortcutMenu.page();
     switch (selection) {
     case KEY_LEFT:
@@ -167,37 +178,21 @@ int Shell::shortcut() {
     case KEY_UP:
       if (ShortcutMenu.highlighted() != 0) {
         ShortcutMenu.moveHighlightUp();
-        if (_LIST_VIEW_ENABLED) {
-          auto listViewPath = directories[ShortcutMenu.highlighted()];
-          try {
-            displayListView(listViewPath);
-          } catch (std::filesystem::filesystem_error &e) {
-            _LSVIEW->eraseWin();
-            _LSVIEW->print(e.what());
-            _LSVIEW->refresh();
-          }
-        }
       }
       break;
     case KEY_DOWN:
       if (ShortcutMenu.highlighted() !=
           ShortcutMenu.numFieldsThisPage() - 1) { // numFieldsThisPage()
         ShortcutMenu.moveHighlightDown();         // moveHighlightUp()
-        if (_LIST_VIEW_ENABLED) {
-          auto listViewPath = directories[ShortcutMenu.highlighted()];
-          try {
-            displayListView(listViewPath);
-          } catch (std::filesystem::filesystem_error &e) {
-            _LSVIEW->eraseWin();
-            _LSVIEW->print(e.what());
-            _LSVIEW->refresh();
-          }
-        }
       }
       break;
     default:
       break;
     }
+    if (_LIST_VIEW_ENABLED &&
+        (selection == KEY_UP || selection == KEY_DOWN ||
+         selection == KEY_LEFT || selection == KEY_RIGHT))
+      previewListView(directories[ShortcutMenu.selectedFieldIndex()]);
 
     bool exitStatus = 0;
     for (const int i : breakConditions) {
@@ -0,0 +1,230 @@
+/**
+ * CommandCapture
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "CommandCapture.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+CommandCapture::CommandCapture(size_t const bufferSize) : _buffer(bufferSize) {}
+
+pid_t CommandCapture::pid() const { return _pid; }
+
+/// true while either pipe of the child is still open.
+bool CommandCapture::open() const { return _fds[0] >= 0 || _fds[1] >= 0; }
+
+int CommandCapture::spawn(std::vector<std::string> const &argv) {
+  // build argv before forking so the child does not allocate.
+  std::vector<char *> args;
+  for (auto const &arg : argv)
+    args.push_back(const_cast<char *>(arg.c_str()));
+  args.push_back(nullptr);
+  return spawn(args.data());
+}
+
+/// fork and exec argv, a null-terminated array, with stdout and stderr
+/// redirected into two pipes. returns 0 on success, or -1 if the pipes or
+/// the fork could not be made.
+int CommandCapture::spawn(char *const *argv) {
+  if (argv == nullptr || argv[0] == nullptr)
+    return -1;
+
+  int outPipe[2];
+  int errPipe[2];
+  if (pipe2(outPipe, O_CLOEXEC) != 0)
+    return -1;
+  if (pipe2(errPipe, O_CLOEXEC) != 0) {
+    ::close(outPipe[0]);
+    ::close(outPipe[1]);
+    return -1;
+  }
+
+  _pid = fork();
+  if (_pid < 0) {
+    ::close(outPipe[0]);
+    ::close(outPipe[1]);
+    ::close(errPipe[0]);
+    ::close(errPipe[1]);
+    return -1;
+  }
+
+  if (_pid == 0) {
+    // child process, in a process group of its own. it is not in the
+    // terminal's foreground group, so it must not read from the terminal.
+    setpgid(0, 0);
+    for (int sig : {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGCHLD})
+      ::signal(sig, SIG_DFL);
+    int const devNull = ::open("/dev/null", O_RDONLY);
+    if (devNull >= 0)
+      dup2(devNull, STDIN_FILENO);
+    dup2(outPipe[1], STDOUT_FILENO);
+    dup2(errPipe[1], STDERR_FILENO);
+    execvp(argv[0], argv);
+    perror(argv[0]);
+    _exit(127);
+  }
+
+  // set the group here too, so it exists before the caller signals it.
+  setpgid(_pid, _pid);
+  ::close(outPipe[1]);
+  ::close(errPipe[1]);
+  _fds[0] = outPipe[0];
+  _fds[1] = errPipe[0];
+  for (int fd : _fds)
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  _partial[0].clear();
+  _partial[1].clear();
+  return 0;
+}
+
+/// wait up to timeoutMs for output on either pipe and pass every complete
+/// line read to onLine. at most one buffer is read from each pipe per call so
+/// that a chatty stream cannot starve the other. returns open().
+bool CommandCapture::pump(int const timeoutMs, line_handler const &onLine) {
+  struct pollfd pfds[2];
+  nfds_t n = 0;
+  size_t idxs[2];
+  for (size_t i = 0; i < 2; ++i) {
+    if (_fds[i] < 0)
+      continue;
+    pfds[n].fd = _fds[i];
+    pfds[n].events = POLLIN;
+    pfds[n].revents = 0;
+    idxs[n] = i;
+    ++n;
+  }
+  if (n == 0)
+    return false;
+
+  int ready = poll(pfds, n, timeoutMs);
+  if (ready <= 0)
+    return open(); // timeout, or interrupted by a signal
+
+  for (nfds_t i = 0; i < n; ++i) {
+    if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR))
+      _drain(idxs[i], onLine);
+  }
+  return open();
+}
+
+void CommandCapture::_drain(size_t const idx, line_handler const &onLine) {
+  ssize_t got = read(_fds[idx], _buffer.data(), _buffer.size());
+  if (got < 0) {
+    if (errno == EAGAIN || errno == EINTR)
+      return;
+    _flushPartial(idx, onLine);
+    _close(idx);
+    return;
+  }
+  if (got == 0) {
+    // end of file
+    _flushPartial(idx, onLine);
+    _close(idx);
+    return;
+  }
+
+  CaptureStream const stream = idx == 0 ? CaptureStream::OUT : CaptureStream::ERR;
+  char const *begin = _buffer.data();
+  char const *end = begin + got;
+  std::string &partial = _partial[idx];
+
+  while (begin < end) {
+    auto const *nl =
+        static_cast<char const *>(memchr(begin, '\n', end - begin));
+    if (nl == nullptr) {
+      partial.append(begin, end);
+      break;
+    }
+    if (partial.empty()) {
+      onLine(stream, std::string(begin, nl));
+    } else {
+      partial.append(begin, nl);
+      onLine(stream, partial);
+      partial.clear();
+    }
+    begin = nl + 1;
+  }
+}
+
+void CommandCapture::_flushPartial(size_t const idx,
+                                   line_handler const &onLine) {
+  if (_partial[idx].empty())
+    return;
+  onLine(idx == 0 ? CaptureStream::OUT : CaptureStream::ERR, _partial[idx]);
+  _partial[idx].clear();
+}
+
+void CommandCapture::_close(size_t const idx) {
+  if (_fds[idx] >= 0)
+    ::close(_fds[idx]);
+  _fds[idx] = -1;
+}
+
+/// close both pipes without reading what is left in them.
+void CommandCapture::close() {
+  _close(0);
+  _close(1);
+  _partial[0].clear();
+  _partial[1].clear();
+}
+
+/// leave reaping the child to the caller, e.g. a Job.
+void CommandCapture::release() { _pid = -1; }
+
+/// reap the child. returns its exit status, or -1 if it did not exit normally.
+int CommandCapture::wait() {
+  if (_pid <= 0)
+    return -1;
+  int status = 0;
+  while (waitpid(_pid, &status, 0) < 0 && errno == EINTR)
+    ;
+  _pid = -1;
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/// spawn argv and block until both of its pipes are closed.
+int CommandCapture::run(std::vector<std::string> const &argv,
+                        line_handler const &onLine) {
+  if (spawn(argv) != 0)
+    return -1;
+  while (pump(-1, onLine))
+    ;
+  return wait();
+}
+
+CommandCapture::~CommandCapture() {
+  _close(0);
+  _close(1);
+  if (_pid > 0)
+    wait();
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,70 @@
+#ifndef TRINKETS_COMMAND_CAPTURE_H
+#define TRINKETS_COMMAND_CAPTURE_H
+
+/**
+ * CommandCapture
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// which pipe of the child a captured line was read from.
+enum class CaptureStream { OUT, ERR };
+
+/// runs a child process with its stdout and stderr attached to pipes and
+/// polls both, so that neither pipe can fill up and block the child while the
+/// other is being read. complete lines are handed to the caller in the order
+/// they arrived.
+struct CommandCapture {
+public:
+  typedef std::function<void(CaptureStream, std::string const &)> line_handler;
+
+  explicit CommandCapture(size_t const bufferSize = 1 << 16);
+
+  int spawn(std::vector<std::string> const &argv);
+  int spawn(char *const *argv);
+  bool pump(int const timeoutMs, line_handler const &onLine);
+  int wait();
+  int run(std::vector<std::string> const &argv, line_handler const &onLine);
+  pid_t pid() const;
+  bool open() const;
+  void close();
+  void release();
+
+  ~CommandCapture();
+
+private:
+  void _drain(size_t const idx, line_handler const &onLine);
+  void _flushPartial(size_t const idx, line_handler const &onLine);
+  void _close(size_t const idx);
+
+  pid_t _pid = -1;
+  int _fds[2] = {-1, -1};
+  std::vector<char> _buffer;
+  std::string _partial[2];
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
@@ -0,0 +1,403 @@
+/**
+ * CommandLexer
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "CommandLexer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+bool isBlank(char const c) { return c == ' ' || c == '\t'; }
+
+bool isOperator(char const c) { return c == '|' || c == '<' || c == '>'; }
+
+bool startsName(char const c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+bool continuesName(char const c) {
+  return startsName(c) || (c >= '0' && c <= '9');
+}
+} // namespace
+
+TokenArena::TokenArena(size_t const blockSize) : _blockSize(blockSize) {}
+
+void TokenArena::put(char const c) {
+  if (_blocks.empty() || _used == _sizes[_block])
+    _grow(1);
+  _blocks[_block][_used++] = c;
+}
+
+void TokenArena::put(char const *str, size_t const len) {
+  if (_blocks.empty() || _sizes[_block] - _used < len)
+    _grow(len);
+  std::memcpy(_blocks[_block].get() + _used, str, len);
+  _used += len;
+}
+
+/// bytes written to the token so far.
+size_t TokenArena::pending() const { return _used - _tokenStart; }
+
+/// end the token being written and return it, null-terminated. it stays
+/// valid until the arena is reset.
+char *TokenArena::finish(size_t &len) {
+  len = pending();
+  put('\0');
+  char *const token = _blocks[_block].get() + _tokenStart;
+  _tokenStart = _used;
+  return token;
+}
+
+/// drop the token being written.
+void TokenArena::discard() { _used = _tokenStart; }
+
+void TokenArena::reset() {
+  _block = 0;
+  _used = 0;
+  _tokenStart = 0;
+}
+
+/// move the token being written to a block with room for need more bytes
+/// and its terminator. tokens already finished stay where they are.
+void TokenArena::_grow(size_t const need) {
+  size_t const partial = pending();
+  size_t const wanted = std::max(_blockSize, partial + need + 1);
+  size_t const next = _blocks.empty() ? 0 : _block + 1;
+
+  if (next == _blocks.size()) {
+    _blocks.emplace_back(new char[wanted]);
+    _sizes.push_back(wanted);
+  } else if (_sizes[next] < wanted) {
+    // blocks past the current one hold nothing yet.
+    _blocks[next].reset(new char[wanted]);
+    _sizes[next] = wanted;
+  }
+
+  if (partial > 0)
+    std::memcpy(_blocks[next].get(), _blocks[_block].get() + _tokenStart,
+                partial);
+  _block = next;
+  _tokenStart = 0;
+  _used = partial;
+}
+
+/// split line into tokens. returns 0 on success, or -1 if the line is not
+/// well formed, in which case error() says why.
+int CommandLexer::lex(std::string_view const line) {
+  _arena.reset();
+  _tokens.clear();
+  _argv.clear();
+  _hasOperators = false;
+  _error = nullptr;
+
+  size_t pos = 0;
+  while (true) {
+    while (pos < line.size() && isBlank(line[pos]))
+      ++pos;
+    if (pos == line.size())
+      break;
+
+    // a redirection may name the descriptor it applies to, as in 2>file.
+    size_t digits = pos;
+    while (digits < line.size() && line[digits] >= '0' && line[digits] <= '9')
+      ++digits;
+    bool const hasFd = digits > pos && digits < line.size() &&
+                       (line[digits] == '<' || line[digits] == '>');
+
+    if (line[pos] == '|' || hasFd || isOperator(line[pos])) {
+      int fd = -1;
+      if (hasFd) {
+        fd = std::atoi(std::string(line.substr(pos, digits - pos)).c_str());
+        pos = digits;
+      }
+      Token token = {TokenKind::PIPE, nullptr, 0, fd};
+      if (line[pos] == '<') {
+        token.kind = TokenKind::REDIRECT_IN;
+        token.fd = hasFd ? fd : 0;
+      } else if (line[pos] == '>') {
+        bool const append = pos + 1 < line.size() && line[pos + 1] == '>';
+        token.kind = append ? TokenKind::REDIRECT_APPEND
+                            : TokenKind::REDIRECT_OUT;
+        token.fd = hasFd ? fd : 1;
+        pos += append;
+      }
+      ++pos;
+      _tokens.push_back(token);
+      _hasOperators = true;
+      continue;
+    }
+
+    // a word. quoted marks that it was written with quotes, so that an empty
+    // "" is kept while an empty unquoted $VAR disappears.
+    size_t const wordStart = pos;
+    bool quoted = false;
+    while (pos < line.size() && !isBlank(line[pos]) &&
+           !isOperator(line[pos])) {
+      char const c = line[pos];
+      if (c == '\'') {
+        size_t const close = line.find('\'', pos + 1);
+        if (close == std::string_view::npos) {
+          _error = "unterminated quote";
+          return -1;
+        }
+        _arena.put(line.data() + pos + 1, close - pos - 1);
+        quoted = true;
+        pos = close + 1;
+      } else if (c == '"') {
+        ++pos;
+        while (pos < line.size() && line[pos] != '"') {
+          if (line[pos] == '\\' && pos + 1 < line.size() &&
+              std::strchr("$\"\\`", line[pos + 1])) {
+            _arena.put(line[pos + 1]);
+            pos += 2;
+          } else if (line[pos] == '$') {
+            if (_expand(line, pos) != 0)
+              return -1;
+          } else {
+            _arena.put(line[pos++]);
+          }
+        }
+        if (pos == line.size()) {
+          _error = "unterminated quote";
+          return -1;
+        }
+        quoted = true;
+        ++pos;
+      } else if (c == '\\') {
+        if (pos + 1 < line.size()) {
+          _arena.put(line[pos + 1]);
+          quoted = true;
+          pos += 2;
+        } else {
+          _arena.put(line[pos++]);
+        }
+      } else if (c == '$') {
+        if (_expand(line, pos) != 0)
+          return -1;
+      } else if (c == '~' && pos == wordStart &&
+                 (pos + 1 == line.size() || line[pos + 1] == '/' ||
+                  isBlank(line[pos + 1]) || isOperator(line[pos + 1]))) {
+        char const *const home = std::getenv("HOME");
+        if (home != nullptr)
+          _arena.put(home, std::strlen(home));
+        else
+          _arena.put(c);
+        ++pos;
+      } else {
+        _arena.put(line[pos++]);
+      }
+    }
+
+    if (_arena.pending() == 0 && !quoted) {
+      _arena.discard();
+      continue;
+    }
+    Token token = {TokenKind::WORD, nullptr, 0, -1};
+    token.text = _arena.finish(token.len);
+    _tokens.push_back(token);
+  }
+
+  if (_check() != 0)
+    return -1;
+
+  for (auto const &token : _tokens)
+    if (token.kind == TokenKind::WORD)
+      _argv.push_back(token.text);
+  _argv.push_back(nullptr);
+  return 0;
+}
+
+/// expand the variable at line[pos], $NAME or ${NAME}, into the word being
+/// written and move pos past it. a $ that does not start a name is kept.
+int CommandLexer::_expand(std::string_view const line, size_t &pos) {
+  size_t start = pos + 1;
+  size_t end = start;
+  bool const braced = start < line.size() && line[start] == '{';
+
+  if (braced) {
+    end = line.find('}', ++start);
+    if (end == std::string_view::npos) {
+      _error = "missing '}'";
+      return -1;
+    }
+  } else {
+    if (end < line.size() && startsName(line[end]))
+      while (end < line.size() && continuesName(line[end]))
+        ++end;
+  }
+
+  if (end == start && !braced) {
+    _arena.put('$');
+    ++pos;
+    return 0;
+  }
+
+  // names are short enough that this string does not allocate.
+  std::string const name(line.substr(start, end - start));
+  char const *const value = std::getenv(name.c_str());
+  if (value != nullptr)
+    _arena.put(value, std::strlen(value));
+  pos = braced ? end + 1 : end;
+  return 0;
+}
+
+/// find the word at the end of line the way lex() finds words, for
+/// completing it as it is typed. the word is empty if the line ends in a
+/// blank or an operator. a word after a redirection is not the first of its
+/// command.
+PartialWord CommandLexer::lastWord(std::string_view const line) {
+  PartialWord word;
+  bool commandHasWord = false;
+  bool redirected = false; // the next word names a file
+  size_t pos = 0;
+  while (true) {
+    while (pos < line.size() && isBlank(line[pos]))
+      ++pos;
+    word.start = pos;
+    word.first = !commandHasWord && !redirected;
+    word.text.clear();
+    word.quote = 0;
+    if (pos == line.size())
+      return word;
+
+    size_t digits = pos;
+    while (digits < line.size() && line[digits] >= '0' && line[digits] <= '9')
+      ++digits;
+    bool const hasFd = digits > pos && digits < line.size() &&
+                       (line[digits] == '<' || line[digits] == '>');
+    if (hasFd || isOperator(line[pos])) {
+      pos = hasFd ? digits : pos;
+      if (line[pos] == '|') {
+        commandHasWord = false;
+        redirected = false;
+      } else {
+        redirected = true;
+        if (line[pos] == '>' && pos + 1 < line.size() && line[pos + 1] == '>')
+          ++pos;
+      }
+      ++pos;
+      continue;
+    }
+
+    while (pos < line.size() && !isBlank(line[pos]) &&
+           !isOperator(line[pos])) {
+      char const c = line[pos];
+      if (c == '\'') {
+        size_t close = line.find('\'', pos + 1);
+        if (close == std::string_view::npos) {
+          word.quote = c;
+          close = line.size();
+        }
+        word.text.append(line.data() + pos + 1, close - pos - 1);
+        pos = std::min(close + 1, line.size());
+      } else if (c == '"') {
+        ++pos;
+        while (pos < line.size() && line[pos] != '"') {
+          if (line[pos] == '\\' && pos + 1 < line.size() &&
+              std::strchr("$\"\\`", line[pos + 1]))
+            ++pos;
+          word.text += line[pos++];
+        }
+        if (pos == line.size())
+          word.quote = c;
+        else
+          ++pos;
+      } else if (c == '\\' && pos + 1 < line.size()) {
+        word.text += line[pos + 1];
+        pos += 2;
+      } else {
+        word.text += line[pos++];
+      }
+    }
+    if (pos == line.size())
+      return word;
+    if (redirected)
+      redirected = false;
+    else
+      commandHasWord = true;
+  }
+}
+
+/// text written so that lex() reads it back as it is, continuing a word
+/// left inside quote, which is 0 outside quotes.
+std::string CommandLexer::escape(std::string_view const text,
+                                 char const quote) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char const c : text) {
+    if (quote == '\'' && c == '\'') {
+      escaped += "'\\''"; // close, escape it, open again
+      continue;
+    }
+    if ((quote == '"' && std::strchr("$\"\\`", c)) ||
+        (quote == 0 && (isBlank(c) || isOperator(c) ||
+                        std::strchr("'\"\\$~\n", c))))
+      escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+/// every redirection needs a file and every command in a pipeline a word.
+int CommandLexer::_check() {
+  bool commandHasWord = false;
+  for (size_t i = 0; i < _tokens.size(); ++i) {
+    TokenKind const kind = _tokens[i].kind;
+    if (kind == TokenKind::WORD) {
+      commandHasWord = true;
+    } else if (kind == TokenKind::PIPE) {
+      if (!commandHasWord || i + 1 == _tokens.size()) {
+        _error = "empty command in pipeline";
+        return -1;
+      }
+      commandHasWord = false;
+    } else if (i + 1 == _tokens.size() ||
+               _tokens[i + 1].kind != TokenKind::WORD) {
+      _error = "missing file name after redirection";
+      return -1;
+    } else {
+      ++i; // the file name is not part of the command
+    }
+  }
+  return 0;
+}
+
+std::vector<Token> const &CommandLexer::tokens() const { return _tokens; }
+
+/// the words of a line without operators, null-terminated, ready for exec.
+/// valid until the next call to lex().
+char *const *CommandLexer::argv() const { return _argv.data(); }
+
+size_t CommandLexer::argc() const {
+  return _argv.empty() ? 0 : _argv.size() - 1;
+}
+
+bool CommandLexer::hasOperators() const { return _hasOperators; }
+
+char const *CommandLexer::error() const { return _error; }
+
+} // namespace Trinkets
+} // namespace BlackOS
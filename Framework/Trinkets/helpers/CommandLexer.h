@@ -0,0 +1,111 @@
+#ifndef TRINKETS_COMMAND_LEXER_H
+#define TRINKETS_COMMAND_LEXER_H
+
+/**
+ * CommandLexer
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// a bump allocator for the text of tokens. a token is written a byte at a
+/// time, since its length is only known once quotes, escapes and variables
+/// have been dealt with; if it outgrows the current block it moves to the
+/// next. blocks are kept when the arena is reset, so once it has grown to
+/// fit the longest command it does not allocate again.
+class TokenArena {
+public:
+  explicit TokenArena(size_t const blockSize = 4096);
+
+  void put(char const c);
+  void put(char const *str, size_t const len);
+  size_t pending() const;
+  char *finish(size_t &len);
+  void discard();
+  void reset();
+
+private:
+  void _grow(size_t const need);
+
+  size_t _blockSize;
+  std::vector<std::unique_ptr<char[]>> _blocks;
+  std::vector<size_t> _sizes;
+  size_t _block = 0;      // block being written
+  size_t _used = 0;       // bytes used in it
+  size_t _tokenStart = 0; // where the token being written begins
+};
+
+enum class TokenKind { WORD, PIPE, REDIRECT_IN, REDIRECT_OUT, REDIRECT_APPEND };
+
+/// a word, with quotes and escapes removed and variables expanded, or an
+/// operator. text is null-terminated and lives in the lexer's arena until
+/// the next line is lexed.
+struct Token {
+  TokenKind kind;
+  char *text; // nullptr for operators
+  size_t len;
+  int fd; // the descriptor a redirection applies to
+};
+
+/// the word being typed at the end of a line, as lex() would split it. the
+/// line may stop inside quotes.
+struct PartialWord {
+  size_t start = 0;  // where it begins in the line
+  std::string text;  // quotes and escapes removed, variables left as written
+  char quote = 0;    // the quote left open at the end of the line, if any
+  bool first = true; // the first word of its command
+};
+
+/// splits a command line into words and the operators | < > >>, following
+/// the shell: 'single quotes' keep everything, "double quotes" still expand
+/// $VAR and ${VAR}, a backslash escapes the next character and a leading ~
+/// is HOME. the words are also kept as a null-terminated argv that can be
+/// passed to exec as it is.
+class CommandLexer {
+public:
+  int lex(std::string_view const line);
+  std::vector<Token> const &tokens() const;
+  char *const *argv() const;
+  size_t argc() const;
+  bool hasOperators() const;
+  char const *error() const;
+
+  static PartialWord lastWord(std::string_view const line);
+  static std::string escape(std::string_view const text,
+                            char const quote = 0);
+
+private:
+  int _expand(std::string_view const line, size_t &pos);
+  int _check();
+
+  TokenArena _arena;
+  std::vector<Token> _tokens;
+  std::vector<char *> _argv;
+  bool _hasOperators = false;
+  char const *_error = nullptr;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
@@ -0,0 +1,263 @@
+/**
+ * Completion
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "Completion.h"
+#include "CommandLexer.h"
+#include "DirectoryCache.h"
+#include "PathController.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <filesystem>
+#include <stdlib.h>
+#include <string_view>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+bool startsWith(std::string_view const str, std::string_view const prefix) {
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+/// a byte as the name order sees it.
+unsigned char fold(char const c) {
+  return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+/// compare name with prefix as the name order does, looking no further
+/// into name than the length of prefix. names that match prefix this way
+/// lie together in the order.
+int compareFolded(std::string_view const name, std::string_view const prefix) {
+  size_t const len = std::min(name.size(), prefix.size());
+  for (size_t i = 0; i < len; ++i)
+    if (fold(name[i]) != fold(prefix[i]))
+      return fold(name[i]) < fold(prefix[i]) ? -1 : 1;
+  return name.size() < prefix.size() ? -1 : 0;
+}
+} // namespace
+
+Completer::Completer(DirectoryCache *cache) : _cache(cache) {}
+
+void CommandTrie::insert(std::string const &word) {
+  long const existing = _find(word);
+  if (word.empty() || (existing >= 0 && _nodes[existing].word))
+    return;
+  uint32_t node = 0;
+  _nodes[0].words++;
+  for (char const c : word) {
+    auto &children = _nodes[node].children;
+    auto it = std::lower_bound(
+        children.begin(), children.end(), c,
+        [](std::pair<char, uint32_t> const &child, char const ch) {
+          return child.first < ch;
+        });
+    if (it == children.end() || it->first != c) {
+      uint32_t const next = _nodes.size();
+      children.insert(it, {c, next});
+      _nodes.emplace_back(); // invalidates children
+      node = next;
+    } else {
+      node = it->second;
+    }
+    _nodes[node].words++;
+  }
+  _nodes[node].word = true;
+}
+
+/// up to limit words starting with prefix, in order.
+std::vector<std::string> CommandTrie::withPrefix(std::string const &prefix,
+                                                 size_t const limit) const {
+  std::vector<std::string> words;
+  long const node = _find(prefix);
+  if (node < 0)
+    return words;
+  std::string word = prefix;
+  _collect(node, word, words, limit);
+  return words;
+}
+
+/// number of words starting with prefix.
+size_t CommandTrie::count(std::string const &prefix) const {
+  long const node = _find(prefix);
+  return node < 0 ? 0 : _nodes[node].words;
+}
+
+/// prefix, extended for as long as every word starting with it agrees.
+std::string CommandTrie::extend(std::string const &prefix) const {
+  long node = _find(prefix);
+  std::string extended = prefix;
+  while (node >= 0 && !_nodes[node].word &&
+         _nodes[node].children.size() == 1) {
+    extended += _nodes[node].children[0].first;
+    node = _nodes[node].children[0].second;
+  }
+  return extended;
+}
+
+void CommandTrie::clear() { _nodes.assign(1, Node()); }
+
+long CommandTrie::_find(std::string const &prefix) const {
+  uint32_t node = 0;
+  for (char const c : prefix) {
+    auto const &children = _nodes[node].children;
+    auto const it = std::lower_bound(
+        children.begin(), children.end(), c,
+        [](std::pair<char, uint32_t> const &child, char const ch) {
+          return child.first < ch;
+        });
+    if (it == children.end() || it->first != c)
+      return -1;
+    node = it->second;
+  }
+  return node;
+}
+
+void CommandTrie::_collect(uint32_t const node, std::string &word,
+                           std::vector<std::string> &out,
+                           size_t const limit) const {
+  if (out.size() >= limit)
+    return;
+  if (_nodes[node].word)
+    out.push_back(word);
+  for (auto const &child : _nodes[node].children) {
+    word.push_back(child.first);
+    _collect(child.second, word, out, limit);
+    word.pop_back();
+  }
+}
+
+/// fill the command trie with the built-ins and every file in the
+/// directories of path, a colon separated list as in $PATH.
+void Completer::loadCommands(std::vector<std::string> const &builtins,
+                             std::string const &path) {
+  _commands.clear();
+  for (auto const &builtin : builtins)
+    _commands.insert(builtin);
+
+  size_t begin = 0;
+  while (begin <= path.size()) {
+    size_t end = path.find(':', begin);
+    if (end == std::string::npos)
+      end = path.size();
+    std::string const dir = path.substr(begin, end - begin);
+    begin = end + 1;
+    if (dir.empty())
+      continue;
+    DIR *stream = opendir(dir.c_str());
+    if (stream == nullptr)
+      continue;
+    while (struct dirent *entry = readdir(stream)) {
+      // like other shells, trust the directory rather than checking each
+      // file for the executable bit.
+      if (entry->d_name[0] == '.' || entry->d_type == DT_DIR)
+        continue;
+      _commands.insert(entry->d_name);
+    }
+    closedir(stream);
+  }
+  _commandsLoaded = true;
+}
+
+bool Completer::commandsLoaded() const { return _commandsLoaded; }
+
+/// complete the last word of line, listing at most limit candidates. the
+/// word is found, and its quotes read, as CommandLexer reads them.
+Completions Completer::complete(std::string const &line, size_t const limit) {
+  Completions result;
+  PartialWord const partial = CommandLexer::lastWord(line);
+  std::string const &word = partial.text;
+  result.wordStart = partial.start;
+  result.typed = word.size();
+  result.quote = partial.quote;
+
+  if (partial.first && word.find('/') == std::string::npos) {
+    result.total = _commands.count(word);
+    result.common = _commands.extend(word);
+    result.candidates = _commands.withPrefix(word, limit);
+  } else {
+    _completePath(word, limit, result);
+  }
+  return result;
+}
+
+/// complete word as a path; only names starting with '.' complete to hidden
+/// entries.
+void Completer::_completePath(std::string const &word, size_t const limit,
+                              Completions &result) {
+  size_t const slash = word.rfind('/');
+  std::string const dirPart =
+      slash == std::string::npos ? "" : word.substr(0, slash + 1);
+  std::string const name = word.substr(dirPart.size());
+
+  std::string dir = dirPart.empty() ? "." : dirPart;
+  if (startsWith(dir, "~/")) {
+    char const *home = getenv("HOME");
+    dir = std::string(home == nullptr ? "" : home) + dir.substr(1);
+  }
+  std::shared_ptr<DirectoryListing> listing;
+  try {
+    listing = _cache != nullptr ? _cache->load(dir)
+                                : DirectoryListing::read(dir);
+  } catch (std::filesystem::filesystem_error const &) {
+    return;
+  }
+
+  // the name order folds case, so the names starting with name are found
+  // among those that do once both are folded.
+  PathEntries const &entries = listing->entries;
+  auto const &order = listing->order(SortOrder::NAME);
+  auto it = std::partition_point(
+      order.begin(), order.end(), [&](uint32_t const idx) {
+        return compareFolded(entries.name(idx), name) < 0;
+      });
+  bool const showHidden = !name.empty() && name[0] == '.';
+  for (; it != order.end() && compareFolded(entries.name(*it), name) == 0;
+       ++it) {
+    std::string_view const match = entries.name(*it);
+    if (!startsWith(match, name) || (!showHidden && entries.hidden(*it)))
+      continue;
+    // links, and names on filesystems that do not give a type, are
+    // statted to see whether they lead to a directory.
+    if (entries.types[*it] == PathType::UNKNOWN && !entries.statted(*it))
+      listing->stat(*it);
+    std::string candidate(match);
+    if (entries.types[*it] == PathType::DIRECTORY)
+      candidate += '/';
+
+    if (result.total == 0) {
+      result.common = candidate;
+    } else {
+      size_t len = 0;
+      while (len < result.common.size() && len < candidate.size() &&
+             result.common[len] == candidate[len])
+        ++len;
+      result.common.resize(len);
+    }
+    if (result.candidates.size() < limit)
+      result.candidates.push_back(dirPart + candidate);
+    result.total++;
+  }
+  result.common = dirPart + (result.total == 0 ? name : result.common);
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
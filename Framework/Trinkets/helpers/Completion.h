@@ -0,0 +1,98 @@
+#ifndef TRINKETS_COMPLETION_H
+#define TRINKETS_COMPLETION_H
+
+/**
+ * Completion
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+class DirectoryCache;
+
+/// a prefix tree of command names. words come back in sorted order.
+class CommandTrie {
+public:
+  void insert(std::string const &word);
+  std::vector<std::string> withPrefix(std::string const &prefix,
+                                      size_t const limit) const;
+  size_t count(std::string const &prefix) const;
+  std::string extend(std::string const &prefix) const;
+  void clear();
+
+private:
+  struct Node {
+    std::vector<std::pair<char, uint32_t>> children; // sorted by char
+    uint32_t words = 0;                               // in this subtree
+    bool word = false;
+  };
+
+  long _find(std::string const &prefix) const;
+  void _collect(uint32_t const node, std::string &word,
+                std::vector<std::string> &out, size_t const limit) const;
+
+  std::vector<Node> _nodes{1};
+};
+
+/// what a word on the command line can be completed to. the word begins at
+/// wordStart and reads as its first typed bytes once its quotes and escapes
+/// are removed; candidates are whole words, unquoted, and begin with those
+/// bytes. directories end in '/'. at most the requested number of
+/// candidates are listed, out of total, and common is the longest prefix
+/// they all share. quote is the quote left open in the word, if any.
+struct Completions {
+  size_t wordStart = 0;
+  size_t typed = 0;
+  char quote = 0;
+  size_t total = 0;
+  std::string common;
+  std::vector<std::string> candidates;
+};
+
+/// completes the last word of a command line: the first word from the
+/// built-ins and the executables on PATH, any other word, or one containing
+/// a '/', as a path. paths are completed from the listings of a
+/// DirectoryCache, sorted by name, so completing in a large directory a
+/// second time is a binary search.
+class Completer {
+public:
+  explicit Completer(DirectoryCache *cache = nullptr);
+
+  void loadCommands(std::vector<std::string> const &builtins,
+                    std::string const &path);
+  bool commandsLoaded() const;
+  Completions complete(std::string const &line, size_t const limit);
+
+private:
+  void _completePath(std::string const &word, size_t const limit,
+                     Completions &result);
+
+  DirectoryCache *_cache; // nullptr to read each directory again
+  CommandTrie _commands;
+  bool _commandsLoaded = false;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
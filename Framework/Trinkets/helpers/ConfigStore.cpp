@@ -0,0 +1,283 @@
+/**
+ * ConfigStore
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "ConfigStore.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+char const CACHE_MAGIC[8] = {'T', 'R', 'C', 'O', 'N', 'F', '1', '\0'};
+
+enum ConfigProblem : uint32_t { MISSING_VALUE, EXTRA_TEXT };
+
+char const *const PROBLEM_MESSAGES[] = {
+    "expected a value after the key",
+    "unexpected text after the value",
+};
+
+bool isBlank(char const c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+/// map a whole file read-only. returns nullptr for a missing or empty file.
+char const *mapFile(std::filesystem::path const &path, size_t &len) {
+  len = 0;
+  int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+  struct stat st;
+  void *map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    len = st.st_size;
+    map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    len = 0;
+    return nullptr;
+  }
+  return static_cast<char const *>(map);
+}
+} // namespace
+
+bool ConfigStore::Stamp::operator==(Stamp const &other) const {
+  return mtimeNs == other.mtimeNs && size == other.size &&
+         inode == other.inode;
+}
+
+/// read the settings files, from the cache if none has changed since it was
+/// written. returns 0, or -1 if a file could not be read; a missing file
+/// counts as empty.
+int ConfigStore::open(std::array<std::filesystem::path, FILES> const &paths,
+                      std::filesystem::path const &cachePath) {
+  _paths = paths;
+  _cachePath = cachePath;
+  for (size_t i = 0; i < FILES; ++i)
+    _stamps[i] = _stamp(_paths[i]);
+
+  _fromCache = _readCache() == 0;
+  if (_fromCache)
+    return 0;
+
+  _pool.clear();
+  _records.clear();
+  _errorRecords.clear();
+  for (size_t i = 0; i < FILES; ++i) {
+    size_t len = 0;
+    char const *const text = mapFile(_paths[i], len);
+    if (text == nullptr) {
+      if (_stamps[i].size > 0)
+        return -1;
+      continue;
+    }
+    _parse(static_cast<ConfigFile>(i), text, len);
+    munmap(const_cast<char *>(text), len);
+  }
+  _index();
+  _writeCache();
+  return 0;
+}
+
+/// read the files again if any has changed. returns true if it had.
+bool ConfigStore::reload() {
+  for (size_t i = 0; i < FILES; ++i)
+    if (!(_stamp(_paths[i]) == _stamps[i])) {
+      open(_paths, _cachePath);
+      return true;
+    }
+  return false;
+}
+
+/// true if the last load was served by the cache.
+bool ConfigStore::fromCache() const { return _fromCache; }
+
+std::vector<ConfigEntry> const &
+ConfigStore::entries(ConfigFile const file) const {
+  return _entries[static_cast<size_t>(file)];
+}
+
+std::vector<ConfigError> const &ConfigStore::errors() const {
+  return _errors;
+}
+
+/// the modification time, size and inode of path; all zero if it is missing.
+ConfigStore::Stamp ConfigStore::_stamp(std::filesystem::path const &path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    return {0, 0, 0};
+  return {static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+              st.st_mtim.tv_nsec,
+          static_cast<int64_t>(st.st_size), static_cast<uint64_t>(st.st_ino)};
+}
+
+/// load the cache if it was written for the files as they are now. returns
+/// 0, or -1 if it is missing, stale or malformed.
+int ConfigStore::_readCache() {
+  size_t len = 0;
+  char const *const data = mapFile(_cachePath, len);
+  if (data == nullptr)
+    return -1;
+
+  int result = -1;
+  CacheHeader header;
+  if (len >= sizeof(header)) {
+    std::memcpy(&header, data, sizeof(header));
+    size_t const need = sizeof(header) +
+                        (size_t(header.records) + header.errors) *
+                            sizeof(Record) +
+                        header.poolBytes;
+    bool fresh = std::memcmp(header.magic, CACHE_MAGIC, 8) == 0 &&
+                 len == need;
+    for (size_t i = 0; fresh && i < FILES; ++i)
+      fresh = header.stamps[i] == _stamps[i];
+
+    if (fresh) {
+      char const *at = data + sizeof(header);
+      _records.resize(header.records);
+      std::memcpy(_records.data(), at, header.records * sizeof(Record));
+      at += header.records * sizeof(Record);
+      _errorRecords.resize(header.errors);
+      std::memcpy(_errorRecords.data(), at, header.errors * sizeof(Record));
+      at += header.errors * sizeof(Record);
+      _pool.assign(at, header.poolBytes);
+      result = 0;
+    }
+  }
+  munmap(const_cast<char *>(data), len);
+
+  if (result == 0) {
+    // a cache that does not fit its own pool is treated as stale.
+    for (auto const &record : _records)
+      if (record.file >= FILES ||
+          size_t(record.key) + record.keyLen > _pool.size() ||
+          size_t(record.value) + record.valueLen > _pool.size())
+        return -1;
+    for (auto const &record : _errorRecords)
+      if (record.file >= FILES || record.key > EXTRA_TEXT)
+        return -1;
+    _index();
+  }
+  return result;
+}
+
+/// save what was read, replacing the cache in one step so that another
+/// shell never reads half of it. a cache that cannot be written is skipped.
+void ConfigStore::_writeCache() const {
+  CacheHeader header = {};
+  std::memcpy(header.magic, CACHE_MAGIC, 8);
+  for (size_t i = 0; i < FILES; ++i)
+    header.stamps[i] = _stamps[i];
+  header.records = _records.size();
+  header.errors = _errorRecords.size();
+  header.poolBytes = _pool.size();
+
+  std::string const temp =
+      _cachePath.string() + "." + std::to_string(getpid());
+  int const fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        0644);
+  if (fd < 0)
+    return;
+  std::string data(reinterpret_cast<char const *>(&header), sizeof(header));
+  data.append(reinterpret_cast<char const *>(_records.data()),
+              _records.size() * sizeof(Record));
+  data.append(reinterpret_cast<char const *>(_errorRecords.data()),
+              _errorRecords.size() * sizeof(Record));
+  data += _pool;
+  bool const written =
+      ::write(fd, data.data(), data.size()) == ssize_t(data.size());
+  ::close(fd);
+  if (!written || rename(temp.c_str(), _cachePath.c_str()) != 0)
+    unlink(temp.c_str());
+}
+
+/// split text into lines of "key value", copying keys and values into the
+/// pool.
+void ConfigStore::_parse(ConfigFile const file, char const *text,
+                         size_t const len) {
+  char const *const end = text + len;
+  uint32_t line = 0;
+
+  for (char const *at = text; at < end;) {
+    char const *eol = static_cast<char const *>(std::memchr(at, '\n', end - at));
+    if (eol == nullptr)
+      eol = end;
+    ++line;
+
+    // up to three words: the key, the value, and anything left over.
+    char const *words[3] = {};
+    size_t lens[3] = {};
+    size_t count = 0;
+    for (char const *c = at; c < eol && count < 3;) {
+      while (c < eol && isBlank(*c))
+        ++c;
+      if (c == eol)
+        break;
+      words[count] = c;
+      while (c < eol && !isBlank(*c))
+        ++c;
+      lens[count] = c - words[count];
+      ++count;
+    }
+    at = eol + 1;
+
+    if (count == 0 || words[0][0] == '!' || words[0][0] == '#')
+      continue;
+    if (count != 2) {
+      uint32_t const problem = count == 1 ? MISSING_VALUE : EXTRA_TEXT;
+      _errorRecords.push_back(
+          {static_cast<uint32_t>(file), line, problem, 0, 0, 0});
+      continue;
+    }
+
+    Record record = {static_cast<uint32_t>(file), line, 0, 0, 0, 0};
+    record.key = _pool.size();
+    record.keyLen = lens[0];
+    _pool.append(words[0], lens[0]);
+    record.value = _pool.size();
+    record.valueLen = lens[1];
+    _pool.append(words[1], lens[1]);
+    _records.push_back(record);
+  }
+}
+
+/// build the entries and errors handed out from the records.
+void ConfigStore::_index() {
+  for (auto &entries : _entries)
+    entries.clear();
+  _errors.clear();
+
+  std::string_view const pool = _pool;
+  for (auto const &record : _records)
+    _entries[record.file].push_back({pool.substr(record.key, record.keyLen),
+                                     pool.substr(record.value, record.valueLen),
+                                     record.line});
+  for (auto const &record : _errorRecords)
+    _errors.push_back({static_cast<ConfigFile>(record.file), record.line,
+                       PROBLEM_MESSAGES[record.key]});
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
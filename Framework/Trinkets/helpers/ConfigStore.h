@@ -0,0 +1,114 @@
+#ifndef TRINKETS_CONFIG_STORE_H
+#define TRINKETS_CONFIG_STORE_H
+
+/**
+ * ConfigStore
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+enum class ConfigFile : uint32_t { CONFIG, ENVIRONMENT, SHORTCUTS };
+
+/// a line of a settings file: a key and its value. both point into the
+/// store and are valid until it next loads.
+struct ConfigEntry {
+  std::string_view key;
+  std::string_view value;
+  uint32_t line;
+};
+
+/// a line that could not be read.
+struct ConfigError {
+  ConfigFile file;
+  uint32_t line;
+  char const *message;
+};
+
+/// the shell's settings files: config.txt, environment.txt and
+/// shortcuts.txt. each holds one "key value" pair per line; blank lines and
+/// lines starting with ! or # are ignored. the files are mapped and read in
+/// one pass, and what was read is saved in a binary cache, stamped with the
+/// modification time, size and inode of each file, so that while none of
+/// them changes a start costs a stat per file and one read of the cache.
+class ConfigStore {
+public:
+  static size_t const FILES = 3;
+
+  int open(std::array<std::filesystem::path, FILES> const &paths,
+           std::filesystem::path const &cachePath);
+  bool reload();
+  bool fromCache() const;
+  std::vector<ConfigEntry> const &entries(ConfigFile const file) const;
+  std::vector<ConfigError> const &errors() const;
+
+private:
+  struct Stamp {
+    int64_t mtimeNs;
+    int64_t size;
+    uint64_t inode;
+
+    bool operator==(Stamp const &other) const;
+  };
+
+  // entries and errors as they are kept in the cache: offsets into _pool.
+  struct Record {
+    uint32_t file;
+    uint32_t line;
+    uint32_t key; // an error code for errors
+    uint32_t keyLen;
+    uint32_t value;
+    uint32_t valueLen;
+  };
+
+  struct CacheHeader {
+    char magic[8];
+    Stamp stamps[FILES];
+    uint32_t records;
+    uint32_t errors;
+    uint64_t poolBytes;
+  };
+
+  static Stamp _stamp(std::filesystem::path const &path);
+  int _readCache();
+  void _writeCache() const;
+  void _parse(ConfigFile const file, char const *text, size_t const len);
+  void _index();
+
+  std::array<std::filesystem::path, FILES> _paths;
+  std::filesystem::path _cachePath;
+  std::array<Stamp, FILES> _stamps = {};
+  std::string _pool;
+  std::vector<Record> _records;
+  std::vector<Record> _errorRecords;
+  std::array<std::vector<ConfigEntry>, FILES> _entries;
+  std::vector<ConfigError> _errors;
+  bool _fromCache = false;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
@@ -0,0 +1,216 @@
+/**
+ * DirectoryCache
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "DirectoryCache.h"
+
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+// anything that changes what a listing shows.
+uint32_t const WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                            IN_MOVED_TO | IN_ATTRIB | IN_MODIFY |
+                            IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+std::string keyOf(std::filesystem::path const &path) {
+  std::string key = std::filesystem::absolute(path).lexically_normal();
+  if (key.size() > 1 && key.back() == '/')
+    key.pop_back();
+  return key;
+}
+} // namespace
+
+DirectoryCache::DirectoryCache() {
+  _inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+DirectoryCache::~DirectoryCache() {
+  if (_inotifyFd >= 0)
+    ::close(_inotifyFd);
+}
+
+/// the listing of path, read only if it is not cached or has changed since.
+/// a directory that cannot be watched is read every time. throws
+/// std::filesystem::filesystem_error if the directory cannot be read.
+std::shared_ptr<DirectoryListing>
+DirectoryCache::load(std::filesystem::path const &path) {
+  std::string const key = keyOf(path);
+  auto listing = cached(key);
+  if (listing)
+    return listing;
+
+  // watch before reading, so a change made during the read is not missed.
+  _watch(key);
+  try {
+    listing = DirectoryListing::read(key);
+  } catch (...) {
+    _unwatch(key);
+    throw;
+  }
+  _store(key, listing);
+  return listing;
+}
+
+/// the listing of path if it is cached and has not changed, else nullptr.
+std::shared_ptr<DirectoryListing>
+DirectoryCache::cached(std::filesystem::path const &path) {
+  _drainEvents();
+  auto const it = _listings.find(keyOf(path));
+  if (it == _listings.end())
+    return nullptr;
+  _recent.splice(_recent.begin(), _recent, it->second.recent);
+  return it->second.listing;
+}
+
+/// start watching path ahead of reading it elsewhere.
+void DirectoryCache::watch(std::filesystem::path const &path) {
+  _watch(keyOf(path));
+}
+
+/// cache the listing of path, read since watch(). it is not cached if the
+/// directory changed in the meantime, or could not be watched.
+void DirectoryCache::store(std::filesystem::path const &path,
+                           std::shared_ptr<DirectoryListing> const &listing) {
+  _store(keyOf(path), listing);
+}
+
+/// stop watching path after a read that came to nothing.
+void DirectoryCache::unwatch(std::filesystem::path const &path) {
+  _unwatch(keyOf(path));
+}
+
+void DirectoryCache::_watch(std::string const &key) {
+  if (_inotifyFd < 0 || _pending.count(key) != 0)
+    return;
+  int const wd = inotify_add_watch(_inotifyFd, key.c_str(), WATCH_MASK);
+  if (wd < 0)
+    return;
+
+  // another path may lead to the same directory, and so the same watch.
+  auto const watched = _watched.find(wd);
+  if (watched != _watched.end()) {
+    auto const cachedListing = _listings.find(watched->second);
+    if (cachedListing != _listings.end()) {
+      _drop(cachedListing);
+      // dropping it removed the watch.
+      _watch(key);
+      return;
+    }
+    _pending.erase(watched->second);
+    _stale.erase(watched->second);
+  }
+  _watched[wd] = key;
+  _pending[key] = wd;
+}
+
+void DirectoryCache::_store(std::string const &key,
+                            std::shared_ptr<DirectoryListing> const &listing) {
+  _drainEvents();
+  auto const pending = _pending.find(key);
+  if (pending == _pending.end())
+    return;
+  if (_stale.count(key) != 0 || _listings.count(key) != 0) {
+    _unwatch(key);
+    return;
+  }
+  int const wd = pending->second;
+  _pending.erase(pending);
+
+  _recent.push_front(key);
+  _listings[key] = Cached{listing, wd, _recent.begin()};
+  _entries += listing->entries.size();
+  _trim();
+}
+
+void DirectoryCache::_unwatch(std::string const &key) {
+  auto const pending = _pending.find(key);
+  if (pending == _pending.end())
+    return;
+  inotify_rm_watch(_inotifyFd, pending->second);
+  _watched.erase(pending->second);
+  _pending.erase(pending);
+  _stale.erase(key);
+}
+
+void DirectoryCache::clear() {
+  while (!_listings.empty())
+    _drop(_listings.begin());
+}
+
+/// drop the listings of directories that have changed.
+void DirectoryCache::_drainEvents() {
+  if (_inotifyFd < 0)
+    return;
+  alignas(inotify_event) char buffer[16 * 1024];
+  while (true) {
+    ssize_t const n = ::read(_inotifyFd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return;
+    for (ssize_t at = 0; at < n;) {
+      auto const *event = reinterpret_cast<inotify_event *>(buffer + at);
+      at += sizeof(inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        // events were lost; nothing cached or being read can be trusted.
+        clear();
+        for (auto const &pending : _pending)
+          _stale.insert(pending.first);
+        continue;
+      }
+      auto const watched = _watched.find(event->wd);
+      if (watched == _watched.end())
+        continue;
+      if (_pending.count(watched->second) != 0)
+        _stale.insert(watched->second);
+      else
+        _drop(_listings.find(watched->second));
+    }
+  }
+}
+
+/// forget a listing and stop watching its directory. controllers holding
+/// the listing keep it until they load another.
+void DirectoryCache::_drop(
+    std::unordered_map<std::string, Cached>::iterator it) {
+  if (it == _listings.end())
+    return;
+  inotify_rm_watch(_inotifyFd, it->second.wd);
+  _watched.erase(it->second.wd);
+  _recent.erase(it->second.recent);
+  _entries -= it->second.listing->entries.size();
+  _listings.erase(it);
+}
+
+/// drop the least recently used listings while over either limit, keeping
+/// the one just loaded however large it is.
+void DirectoryCache::_trim() {
+  while (_listings.size() > 1 && (_listings.size() > _MAX_DIRECTORIES ||
+                                  _entries > _MAX_ENTRIES))
+    _drop(_listings.find(_recent.back()));
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
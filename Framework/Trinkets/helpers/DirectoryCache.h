@@ -0,0 +1,88 @@
+#ifndef TRINKETS_DIRECTORY_CACHE_H
+#define TRINKETS_DIRECTORY_CACHE_H
+
+/**
+ * DirectoryCache
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "PathController.h"
+
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <unordered_map>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// keeps the listings of recently visited directories, so going back to one
+/// is a hash lookup rather than a read and a sort. each cached directory is
+/// watched with inotify, and a listing is dropped as soon as a child is
+/// added, removed, renamed or changed. changes inside a child directory,
+/// which only touch that child's mtime, are not seen. the least recently
+/// used listings are dropped once there are too many, or too many entries.
+/// a listing read elsewhere, e.g. bit by bit, is cached by watching its
+/// directory before the read and storing the listing after it.
+class DirectoryCache {
+public:
+  DirectoryCache();
+  DirectoryCache(DirectoryCache const &) = delete;
+  DirectoryCache &operator=(DirectoryCache const &) = delete;
+  ~DirectoryCache();
+
+  std::shared_ptr<DirectoryListing> load(std::filesystem::path const &path);
+  std::shared_ptr<DirectoryListing> cached(std::filesystem::path const &path);
+  void watch(std::filesystem::path const &path);
+  void store(std::filesystem::path const &path,
+             std::shared_ptr<DirectoryListing> const &listing);
+  void unwatch(std::filesystem::path const &path);
+  void clear();
+
+private:
+  static size_t const _MAX_DIRECTORIES = 64;
+  static size_t const _MAX_ENTRIES = 1 << 20;
+
+  struct Cached {
+    std::shared_ptr<DirectoryListing> listing;
+    int wd; // inotify watch
+    std::list<std::string>::iterator recent;
+  };
+
+  void _drainEvents();
+  void _watch(std::string const &key);
+  void _store(std::string const &key,
+              std::shared_ptr<DirectoryListing> const &listing);
+  void _unwatch(std::string const &key);
+  void _drop(std::unordered_map<std::string, Cached>::iterator it);
+  void _trim();
+
+  int _inotifyFd = -1;
+  std::unordered_map<std::string, Cached> _listings; // by absolute path
+  std::unordered_map<std::string, int> _pending;     // watched, being read
+  std::unordered_map<int, std::string> _watched;     // watch to path
+  std::unordered_set<std::string> _stale; // changed while being read
+  std::list<std::string> _recent;         // most recent first
+  size_t _entries = 0;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
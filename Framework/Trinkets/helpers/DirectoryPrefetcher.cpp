@@ -0,0 +1,168 @@
+/**
+ * DirectoryPrefetcher
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "DirectoryPrefetcher.h"
+#include "DirectoryCache.h"
+
+#include <algorithm>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+// jobs are read on other threads, and kept after the working directory may
+// have changed, so they are given absolute paths.
+std::filesystem::path absolutePath(std::filesystem::path const &path) {
+  return std::filesystem::absolute(path).lexically_normal();
+}
+} // namespace
+
+DirectoryPrefetcher::DirectoryPrefetcher(DirectoryCache &cache)
+    : _cache(cache) {
+  for (size_t i = 0; i < _WORKERS; ++i)
+    _workers.emplace_back(&DirectoryPrefetcher::_run, this);
+}
+
+DirectoryPrefetcher::~DirectoryPrefetcher() {
+  cancel();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _queued.notify_all();
+  for (auto &worker : _workers)
+    worker.join();
+  collect();
+}
+
+/// read the listings of paths, most wanted first, sorted in the given
+/// order. those asked for before and not asked for again are given up on.
+void DirectoryPrefetcher::prefetch(
+    std::vector<std::filesystem::path> const &paths, SortOrder const order) {
+  collect();
+  std::vector<std::filesystem::path> absolutes;
+  std::vector<std::string> keys;
+  for (auto const &path : paths) {
+    absolutes.push_back(absolutePath(path));
+    keys.push_back(absolutes.back().string());
+  }
+  for (auto &wanted : _wanted)
+    *wanted.second =
+        std::find(keys.begin(), keys.end(), wanted.first) == keys.end();
+
+  std::vector<Job> jobs;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    if (_wanted.count(keys[i]) != 0 || _cache.cached(absolutes[i]))
+      continue;
+    _cache.watch(absolutes[i]); // before reading, so no change is missed
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    _wanted[keys[i]] = cancelled;
+    jobs.push_back(Job{absolutes[i], order, cancelled, nullptr});
+  }
+  if (jobs.empty())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jobs.insert(_jobs.begin(), jobs.begin(), jobs.end());
+  }
+  _queued.notify_all();
+}
+
+/// hand the listings read since the last call to the cache, and stop
+/// watching the directories given up on.
+void DirectoryPrefetcher::collect() {
+  std::vector<Job> done;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    done.swap(_done);
+  }
+  for (auto &job : done) {
+    _wanted.erase(job.path.string());
+    if (job.listing)
+      _cache.store(job.path, job.listing);
+    else
+      _cache.unwatch(job.path);
+  }
+}
+
+/// true while path is being read, or waits to be, and has not been given
+/// up on.
+bool DirectoryPrefetcher::wanted(std::filesystem::path const &path) const {
+  auto const it = _wanted.find(absolutePath(path).string());
+  return it != _wanted.end() && !*it->second;
+}
+
+/// give up on every directory asked for.
+void DirectoryPrefetcher::cancel() {
+  for (auto &wanted : _wanted)
+    *wanted.second = true;
+}
+
+void DirectoryPrefetcher::_run() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _queued.wait(lock, [this] { return _stop || !_jobs.empty(); });
+    if (_jobs.empty())
+      return;
+    Job job = std::move(_jobs.front());
+    _jobs.pop_front();
+    lock.unlock();
+    _read(job);
+    lock.lock();
+    _done.push_back(std::move(job));
+  }
+}
+
+/// read and sort the listing of a job, unless it is given up on first.
+void DirectoryPrefetcher::_read(Job &job) {
+  if (*job.cancelled)
+    return;
+  std::shared_ptr<DirectoryListing> listing;
+  try {
+    listing = DirectoryListing::open(job.path);
+  } catch (std::filesystem::filesystem_error &) {
+    return;
+  }
+  int result = 1;
+  while (result > 0) {
+    if (*job.cancelled || listing->entries.size() > _MAX_ENTRIES)
+      return;
+    result = DirectoryListing::readSome(listing->dirFd, listing->entries);
+  }
+  if (result < 0)
+    return;
+
+  // what the order needs, as PathController would find it.
+  PathEntries const &entries = listing->entries;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (*job.cancelled)
+      return;
+    bool const unknown = entries.types[i] == PathType::UNKNOWN;
+    if (!entries.statted(i) && (sortNeedsMetadata(job.order) ||
+                                (job.order == SortOrder::TYPE && unknown)))
+      listing->stat(i);
+  }
+  listing->order(job.order);
+  job.listing = listing;
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,90 @@
+#ifndef TRINKETS_DIRECTORY_PREFETCHER_H
+#define TRINKETS_DIRECTORY_PREFETCHER_H
+
+/**
+ * DirectoryPrefetcher
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "ListingSort.h"
+#include "PathController.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+class DirectoryCache;
+
+/// reads the listings of directories the user is likely to open next on a
+/// few threads of its own, so that opening one finds it in the cache. each
+/// directory is watched before it is read, as any read into the cache is.
+/// asking for other directories gives up on those no longer wanted, even
+/// part way through a read. listings are handed to the cache by collect(),
+/// on the thread that owns the cache. directories too large to be worth
+/// reading ahead are left to be read when opened.
+class DirectoryPrefetcher {
+public:
+  explicit DirectoryPrefetcher(DirectoryCache &cache);
+  DirectoryPrefetcher(DirectoryPrefetcher const &) = delete;
+  DirectoryPrefetcher &operator=(DirectoryPrefetcher const &) = delete;
+  ~DirectoryPrefetcher();
+
+  void prefetch(std::vector<std::filesystem::path> const &paths,
+                SortOrder const order);
+  void collect();
+  bool wanted(std::filesystem::path const &path) const;
+  void cancel();
+
+private:
+  struct Job {
+    std::filesystem::path path;
+    SortOrder order;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    std::shared_ptr<DirectoryListing> listing; // null if given up on
+  };
+
+  void _run();
+  static void _read(Job &job);
+
+  static size_t const _WORKERS = 2;
+  static size_t const _MAX_ENTRIES = 1 << 16; // read ahead, per directory
+
+  DirectoryCache &_cache;
+  std::mutex _mutex;
+  std::condition_variable _queued;
+  std::deque<Job> _jobs;  // waiting, most wanted first
+  std::vector<Job> _done; // read or given up on, to be collected
+  bool _stop = false;
+  std::vector<std::thread> _workers;
+  // the directories watched and not yet collected, by path.
+  std::unordered_map<std::string, std::shared_ptr<std::atomic<bool>>> _wanted;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
@@ -0,0 +1,241 @@
+/**
+ * DirectoryRank
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "DirectoryRank.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+char const TABLE_MAGIC[8] = {'T', 'R', 'D', 'I', 'R', 'S', '1', '\0'};
+size_t const CAPACITY = 1024;     // directories remembered
+double const MAX_TOTAL_RANK = 10000; // ranks are aged past this total
+} // namespace
+
+/// open the table at tablePath, creating it if needed. returns 0 on
+/// success or -1 if it cannot be opened or mapped.
+int DirectoryRank::open(std::filesystem::path const &tablePath) {
+  _close();
+  _fd = ::open(tablePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (_fd < 0)
+    return -1;
+
+  size_t const len = sizeof(TableHeader) + CAPACITY * sizeof(Record);
+  _lock();
+  struct stat st;
+  bool const sized = fstat(_fd, &st) == 0 && (size_t)st.st_size == len;
+  if (!sized && ftruncate(_fd, len) != 0) {
+    _unlock();
+    _close();
+    return -1;
+  }
+  void *map = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+  if (map == MAP_FAILED) {
+    _unlock();
+    _close();
+    return -1;
+  }
+  _table = static_cast<char *>(map);
+  _mapped = len;
+  if (!sized || std::memcmp(_header()->magic, TABLE_MAGIC, 8) != 0 ||
+      _header()->count > CAPACITY) {
+    std::memset(_table, 0, len);
+    std::memcpy(_header()->magic, TABLE_MAGIC, 8);
+  }
+  _unlock();
+  return 0;
+}
+
+/// count a visit to dir. when the table is full the lowest ranked directory
+/// makes way. paths too long for a record are not ranked.
+void DirectoryRank::visit(std::string const &dir, time_t const now) {
+  if (_table == nullptr || dir.empty() || dir.size() >= PATH_MAX_LEN)
+    return;
+
+  _lock();
+  long idx = _find(dir);
+  if (idx < 0) {
+    Record *records = _records();
+    if (_header()->count < CAPACITY) {
+      idx = _header()->count++;
+    } else {
+      idx = 0;
+      for (size_t i = 1; i < CAPACITY; ++i)
+        if (_score(records[i], now) < _score(records[idx], now))
+          idx = i;
+    }
+    Record &record = records[idx];
+    record.rank = 0;
+    record.pathLen = dir.size();
+    std::memcpy(record.path, dir.c_str(), dir.size() + 1);
+  }
+  Record &record = _records()[idx];
+  record.rank += 1;
+  record.lastVisit = now;
+  _age();
+  _unlock();
+}
+
+/// stop ranking dir, e.g. once it has been removed.
+void DirectoryRank::forget(std::string const &dir) {
+  if (_table == nullptr)
+    return;
+  _lock();
+  long const idx = _find(dir);
+  if (idx >= 0) {
+    Record *records = _records();
+    records[idx] = records[--_header()->count];
+  }
+  _unlock();
+}
+
+/// the ranked directories whose path contains every fragment, in order and
+/// ignoring case, with the last fragment in the last component of the path;
+/// best first. "j pro src" matches ~/projects/tr/src but not
+/// ~/projects/src/tr.
+std::vector<DirectoryRank::scored_path>
+DirectoryRank::match(std::vector<std::string> const &fragments,
+                     time_t const now) const {
+  std::vector<scored_path> matches;
+  if (_table == nullptr || fragments.empty())
+    return matches;
+
+  // other shells age and move records in place; they wait for the scan.
+  _lock(LOCK_SH);
+  Record const *records = _records();
+  size_t const count = std::min<size_t>(_header()->count, CAPACITY);
+  for (size_t i = 0; i < count; ++i) {
+    Record const &record = records[i];
+    char const *at = record.path;
+    for (size_t f = 0; at != nullptr && f < fragments.size(); ++f) {
+      if (f + 1 == fragments.size()) {
+        char const *lastComponent = std::strrchr(record.path, '/');
+        if (lastComponent != nullptr && lastComponent + 1 > at)
+          at = lastComponent + 1;
+      }
+      at = strcasestr(at, fragments[f].c_str());
+      if (at != nullptr)
+        at += fragments[f].size();
+    }
+    if (at != nullptr)
+      matches.emplace_back(std::string(record.path, record.pathLen),
+                           _score(record, now));
+  }
+  _unlock();
+  std::sort(matches.begin(), matches.end(),
+            [](scored_path const &a, scored_path const &b) {
+              return a.second > b.second;
+            });
+  return matches;
+}
+
+/// every ranked directory, best first.
+std::vector<DirectoryRank::scored_path>
+DirectoryRank::ranked(time_t const now) const {
+  return match({""}, now);
+}
+
+/// frecency of a record: its visit count, weighted by how recently the
+/// last visit was.
+double DirectoryRank::_score(Record const &record, time_t const now) {
+  int64_t const age = now - record.lastVisit;
+  if (age < 60 * 60)
+    return record.rank * 4;
+  if (age < 24 * 60 * 60)
+    return record.rank * 2;
+  if (age < 7 * 24 * 60 * 60)
+    return record.rank / 2;
+  return record.rank / 4;
+}
+
+long DirectoryRank::_find(std::string const &dir) const {
+  Record const *records = _records();
+  size_t const count = _header()->count;
+  for (size_t i = 0; i < count; ++i)
+    if (records[i].pathLen == dir.size() &&
+        std::memcmp(records[i].path, dir.data(), dir.size()) == 0)
+      return i;
+  return -1;
+}
+
+/// scale the ranks down once their total passes MAX_TOTAL_RANK, so that old
+/// habits fade, and drop directories that are no longer visited.
+void DirectoryRank::_age() {
+  Record *records = _records();
+  size_t count = _header()->count;
+  double total = 0;
+  for (size_t i = 0; i < count; ++i)
+    total += records[i].rank;
+  if (total <= MAX_TOTAL_RANK)
+    return;
+
+  double const factor = 0.9 * MAX_TOTAL_RANK / total;
+  for (size_t i = 0; i < count;) {
+    records[i].rank *= factor;
+    if (records[i].rank < 1)
+      records[i] = records[--count];
+    else
+      ++i;
+  }
+  _header()->count = count;
+}
+
+/// ranks are updated by one shell at a time, and read while none is
+/// updating them with LOCK_SH.
+void DirectoryRank::_lock(int const operation) const {
+  while (flock(_fd, operation) != 0 && errno == EINTR)
+    ;
+}
+
+void DirectoryRank::_unlock() const { flock(_fd, LOCK_UN); }
+
+DirectoryRank::Record *DirectoryRank::_records() const {
+  return reinterpret_cast<Record *>(_table + sizeof(TableHeader));
+}
+
+DirectoryRank::TableHeader *DirectoryRank::_header() const {
+  return reinterpret_cast<TableHeader *>(_table);
+}
+
+void DirectoryRank::_close() {
+  if (_table != nullptr)
+    munmap(_table, _mapped);
+  _table = nullptr;
+  _mapped = 0;
+  if (_fd >= 0)
+    ::close(_fd);
+  _fd = -1;
+}
+
+DirectoryRank::~DirectoryRank() { _close(); }
+
+} // namespace Trinkets
+} // namespace BlackOS
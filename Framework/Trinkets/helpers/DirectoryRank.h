@@ -0,0 +1,84 @@
+#ifndef TRINKETS_DIRECTORY_RANK_H
+#define TRINKETS_DIRECTORY_RANK_H
+
+/**
+ * DirectoryRank
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <sys/file.h>
+#include <utility>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// ranks the directories the shell has visited by frecency: how often they
+/// were visited, weighted by how recently. the ranks live in a table of
+/// fixed-size records mapped from a file, shared by every running shell, so
+/// nothing is parsed at startup and a lookup is a scan of a few hundred
+/// kilobytes at most.
+class DirectoryRank {
+public:
+  typedef std::pair<std::string, double> scored_path;
+
+  int open(std::filesystem::path const &tablePath);
+  void visit(std::string const &dir, time_t const now = time(nullptr));
+  void forget(std::string const &dir);
+  std::vector<scored_path> match(std::vector<std::string> const &fragments,
+                                 time_t const now = time(nullptr)) const;
+  std::vector<scored_path> ranked(time_t const now = time(nullptr)) const;
+
+  ~DirectoryRank();
+
+private:
+  static size_t const PATH_MAX_LEN = 239;
+
+  struct Record {
+    double rank;
+    int64_t lastVisit;
+    uint8_t pathLen;
+    char path[PATH_MAX_LEN];
+  };
+
+  struct TableHeader {
+    char magic[8];
+    uint64_t count;
+  };
+
+  static double _score(Record const &record, time_t const now);
+  long _find(std::string const &dir) const;
+  void _age();
+  void _lock(int const operation = LOCK_EX) const;
+  void _unlock() const;
+  Record *_records() const;
+  TableHeader *_header() const;
+  void _close();
+
+  int _fd = -1;
+  char *_table = nullptr;
+  size_t _mapped = 0;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
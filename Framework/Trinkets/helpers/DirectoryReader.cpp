@@ -0,0 +1,72 @@
+/**
+ * DirectoryReader
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "DirectoryReader.h"
+
+#include <chrono>
+
+namespace BlackOS {
+namespace Trinkets {
+
+DirectoryReader::DirectoryReader(int const dirFd)
+    : _dirFd(dirFd), _thread(&DirectoryReader::_run, this) {}
+
+DirectoryReader::~DirectoryReader() {
+  _stop = true;
+  _thread.join();
+}
+
+/// move the entries read since the last call onto the end of entries,
+/// waiting up to timeoutMs for some if there are none. returns true once
+/// the whole directory has been read and taken.
+bool DirectoryReader::take(PathEntries &entries, int const timeoutMs) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _arrived.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                    [this] { return _batch.size() != 0 || _done; });
+  entries.append(_batch);
+  _batch.clear();
+  return _done;
+}
+
+/// the errno that stopped the read early, or 0.
+int DirectoryReader::error() const { return _error; }
+
+void DirectoryReader::_run() {
+  PathEntries read;
+  int result = 1;
+  while (result > 0 && !_stop) {
+    result = DirectoryListing::readSome(_dirFd, read);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_batch.size() == 0)
+      std::swap(_batch, read);
+    else
+      _batch.append(read);
+    read.clear();
+    if (result <= 0) {
+      _error = -result;
+      _done = true;
+    }
+    _arrived.notify_one();
+  }
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,63 @@
+#ifndef TRINKETS_DIRECTORY_READER_H
+#define TRINKETS_DIRECTORY_READER_H
+
+/**
+ * DirectoryReader
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "PathController.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// reads a directory on a thread of its own, so its first entries can be
+/// shown while the rest are still being read. the entries are handed over
+/// in batches, in the order the directory gives them. the directory must
+/// stay open until the reader is destroyed, which stops it.
+class DirectoryReader {
+public:
+  explicit DirectoryReader(int const dirFd);
+  DirectoryReader(DirectoryReader const &) = delete;
+  DirectoryReader &operator=(DirectoryReader const &) = delete;
+  ~DirectoryReader();
+
+  bool take(PathEntries &entries, int const timeoutMs);
+  int error() const;
+
+private:
+  void _run();
+
+  int const _dirFd;
+  std::mutex _mutex;
+  std::condition_variable _arrived;
+  PathEntries _batch; // read but not yet taken
+  bool _done = false;
+  int _error = 0;
+  std::atomic<bool> _stop{false};
+  std::thread _thread;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
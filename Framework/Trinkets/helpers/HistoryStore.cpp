@@ -0,0 +1,340 @@
+/**
+ * HistoryStore
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "HistoryStore.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+char const INDEX_MAGIC[8] = {'T', 'R', 'H', 'I', 'S', 'T', '1', '\0'};
+size_t const INITIAL_CAPACITY = 1024; // entries
+size_t const SEARCH_BLOCK = 1 << 16;  // bytes searched per step back
+} // namespace
+
+/// open the log at logPath, creating it if needed, and its index beside it
+/// (logPath with the extension .idx). commands already in the log but not
+/// yet in the index, e.g. from an older version, are indexed. returns 0 on
+/// success or -1 if either file cannot be opened.
+///
+/// several shells may share the files. writers hold an exclusive flock on
+/// the log while they append and index, and the index is mapped shared, so
+/// each command is indexed once by whichever process finds it first.
+/// readers hold a shared flock, and check that the files still cover what
+/// they have mapped before touching it.
+int HistoryStore::open(std::filesystem::path const &logPath) {
+  _close();
+  auto indexPath = logPath;
+  indexPath.replace_extension(".idx");
+
+  _logFd = ::open(logPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                  0600);
+  _indexFd = ::open(indexPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (_logFd < 0 || _indexFd < 0) {
+    _close();
+    return -1;
+  }
+
+  struct stat st;
+  if (_lock() != 0 || fstat(_indexFd, &st) != 0) {
+    _close();
+    return -1;
+  }
+  bool valid = (size_t)st.st_size >= sizeof(IndexHeader) &&
+               _mapIndex(st.st_size) == 0 &&
+               std::memcmp(_header()->magic, INDEX_MAGIC, 8) == 0 &&
+               _header()->entries <= _capacity();
+  int const result = valid || _resetIndex() == 0 ? _indexTail() : -1;
+  _unlock();
+  if (result != 0)
+    _close();
+  return result;
+}
+
+/// add a command to the end of the history. empty commands and commands
+/// spanning several lines are not kept. returns 0 on success.
+int HistoryStore::append(std::string const &command) {
+  if (_logFd < 0 || command.empty() ||
+      command.find('\n') != std::string::npos)
+    return -1;
+
+  // one write per record, so that the log never holds half a command.
+  std::string const record = command + '\n';
+  if (_lock() != 0)
+    return -1;
+  ssize_t put;
+  do {
+    put = ::write(_logFd, record.data(), record.size());
+  } while (put < 0 && errno == EINTR);
+  int const result = put == (ssize_t)record.size() ? _indexTail() : -1;
+  _unlock();
+  return result;
+}
+
+/// pick up the commands other shells have added since the last sync or
+/// append. only the log past the last known offset is looked at, and when
+/// nothing has been added this costs a single fstat. returns 0 on success.
+int HistoryStore::sync() {
+  if (_logFd < 0)
+    return -1;
+  struct stat st;
+  if (fstat(_logFd, &st) != 0)
+    return -1;
+  if ((size_t)st.st_size == _logBytes)
+    return 0;
+  if (_lock() != 0)
+    return -1;
+  int const result = _indexTail();
+  _unlock();
+  return result;
+}
+
+/// number of commands in the history, as of the last sync or append.
+size_t HistoryStore::size() const { return _entries; }
+
+/// the command numbered idx. the view stays valid until the next sync or
+/// append.
+std::string_view HistoryStore::entry(size_t const idx) const {
+  if (idx >= size() || _lock(LOCK_SH) != 0)
+    return {};
+  std::string_view command;
+  uint64_t const offset = _readable() ? _offsets()[idx] : _logBytes;
+  if (offset < _logBytes) {
+    char const *begin = _log + offset;
+    char const *end = static_cast<char const *>(
+        std::memchr(begin, '\n', _logBytes - offset));
+    command = std::string_view(begin, end ? end - begin : _logBytes - offset);
+  }
+  _unlock();
+  return command;
+}
+
+/// the number of the most recent command older than before that contains
+/// query, or -1 if there is none; no command spans lines, so neither does a
+/// match. the log is scanned backwards in blocks straight from the mapping,
+/// so the cost depends on how far back the match is rather than on the size
+/// of the history.
+long HistoryStore::search(std::string_view const query,
+                          size_t const before) const {
+  size_t const entries = std::min(before, size());
+  if (query.empty() || query.find('\n') != std::string_view::npos ||
+      entries == 0 || _lock(LOCK_SH) != 0)
+    return -1;
+  long const found = _readable() ? _search(query, entries) : -1;
+  _unlock();
+  return found;
+}
+
+/// search() with the lock held, over the first entries commands.
+long HistoryStore::_search(std::string_view const query,
+                           size_t const entries) const {
+  uint64_t const *offsets = _offsets();
+  size_t const regionEnd =
+      entries < size() ? std::min<size_t>(offsets[entries], _logBytes)
+                       : _logBytes;
+
+  size_t end = regionEnd;
+  while (end > 0) {
+    size_t const begin = end > SEARCH_BLOCK ? end - SEARCH_BLOCK : 0;
+    // let a match that starts in this block run on into the next one.
+    size_t const limit = std::min(regionEnd, end + query.size() - 1);
+
+    char const *last = nullptr;
+    char const *at = _log + begin;
+    while (at < _log + limit) {
+      auto const *found = static_cast<char const *>(
+          memmem(at, _log + limit - at, query.data(), query.size()));
+      if (found == nullptr)
+        break;
+      last = found;
+      at = found + 1;
+    }
+    if (last != nullptr) {
+      uint64_t const offset = last - _log;
+      return std::upper_bound(offsets, offsets + entries, offset) - offsets -
+             1;
+    }
+    end = begin;
+  }
+  return -1;
+}
+
+/// index the commands the log has gained since it was last indexed, and
+/// take a snapshot of the index for size(), entry() and search(). called
+/// with the lock held.
+int HistoryStore::_indexTail() {
+  struct stat st;
+  // another shell may have grown the index.
+  if (fstat(_indexFd, &st) != 0 ||
+      ((size_t)st.st_size > _indexMapped && _mapIndex(st.st_size) != 0))
+    return -1;
+  if (fstat(_logFd, &st) != 0)
+    return -1;
+  size_t const logSize = st.st_size;
+
+  // the log was replaced or cut short; its offsets are no longer valid.
+  if (logSize < _header()->logBytes && _resetIndex() != 0)
+    return -1;
+  if (_mapLog(logSize) != 0)
+    return -1;
+
+  size_t pos = _header()->logBytes;
+  while (pos < logSize) {
+    auto const *newline = static_cast<char const *>(
+        std::memchr(_log + pos, '\n', logSize - pos));
+    if (newline == nullptr)
+      break;
+    size_t const next = newline - _log + 1;
+    if (newline != _log + pos) {
+      if (_header()->entries == _capacity() &&
+          _mapIndex(sizeof(IndexHeader) +
+                    2 * _capacity() * sizeof(uint64_t)) != 0)
+        return -1;
+      _offsets()[_header()->entries++] = pos;
+    }
+    _header()->logBytes = next;
+    pos = next;
+  }
+  _entries = _header()->entries;
+  _logBytes = _header()->logBytes;
+  return 0;
+}
+
+/// map the first len bytes of the log.
+int HistoryStore::_mapLog(size_t const len) {
+  if (len == _logMapped)
+    return 0;
+  if (_log != nullptr)
+    munmap(const_cast<char *>(_log), _logMapped);
+  _log = nullptr;
+  _logMapped = 0;
+  if (len == 0)
+    return 0;
+  void *map = mmap(nullptr, len, PROT_READ, MAP_SHARED, _logFd, 0);
+  if (map == MAP_FAILED)
+    return -1;
+  _log = static_cast<char const *>(map);
+  _logMapped = len;
+  return 0;
+}
+
+/// map the index as len bytes, growing the file if it is shorter.
+int HistoryStore::_mapIndex(size_t const len) {
+  struct stat st;
+  if (fstat(_indexFd, &st) != 0)
+    return -1;
+  if ((size_t)st.st_size < len && ftruncate(_indexFd, len) != 0)
+    return -1;
+  if (_index != nullptr)
+    munmap(_index, _indexMapped);
+  _index = nullptr;
+  _indexMapped = 0;
+  void *map =
+      mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, _indexFd, 0);
+  if (map == MAP_FAILED)
+    return -1;
+  _index = static_cast<char *>(map);
+  _indexMapped = len;
+  return 0;
+}
+
+/// start an empty index; the whole log is indexed again. the file is never
+/// made shorter, as other shells may have it mapped at its present size.
+int HistoryStore::_resetIndex() {
+  struct stat st;
+  if (fstat(_indexFd, &st) != 0)
+    return -1;
+  size_t const len =
+      std::max<size_t>(st.st_size, sizeof(IndexHeader) +
+                                       INITIAL_CAPACITY * sizeof(uint64_t));
+  if (_mapIndex(len) != 0)
+    return -1;
+  std::memcpy(_header()->magic, INDEX_MAGIC, 8);
+  _header()->logBytes = 0;
+  _header()->entries = 0;
+  return 0;
+}
+
+/// take the lock that serialises writers of the log and index, shared by
+/// readers with LOCK_SH.
+int HistoryStore::_lock(int const operation) const {
+  int result;
+  do {
+    result = flock(_logFd, operation);
+  } while (result != 0 && errno == EINTR);
+  return result;
+}
+
+void HistoryStore::_unlock() const { flock(_logFd, LOCK_UN); }
+
+/// true if the snapshot taken at the last sync or append can still be read:
+/// neither file has been cut short, and no shell has started the index again
+/// since. until the next sync nothing is read otherwise, as a mapping read
+/// past the end of its file raises SIGBUS. called with the lock held.
+bool HistoryStore::_readable() const {
+  struct stat log, index;
+  return fstat(_logFd, &log) == 0 && fstat(_indexFd, &index) == 0 &&
+         (size_t)log.st_size >= _logBytes &&
+         (size_t)index.st_size >=
+             sizeof(IndexHeader) + _entries * sizeof(uint64_t) &&
+         _header()->logBytes >= _logBytes;
+}
+
+HistoryStore::IndexHeader *HistoryStore::_header() const {
+  return reinterpret_cast<IndexHeader *>(_index);
+}
+
+uint64_t *HistoryStore::_offsets() const {
+  return reinterpret_cast<uint64_t *>(_index + sizeof(IndexHeader));
+}
+
+/// number of offsets the mapped index has room for.
+size_t HistoryStore::_capacity() const {
+  return (_indexMapped - sizeof(IndexHeader)) / sizeof(uint64_t);
+}
+
+void HistoryStore::_close() {
+  _mapLog(0);
+  if (_index != nullptr)
+    munmap(_index, _indexMapped);
+  _index = nullptr;
+  _indexMapped = 0;
+  _entries = _logBytes = 0;
+  if (_logFd >= 0)
+    ::close(_logFd);
+  if (_indexFd >= 0)
+    ::close(_indexFd);
+  _logFd = _indexFd = -1;
+}
+
+HistoryStore::~HistoryStore() { _close(); }
+
+} // namespace Trinkets
+} // namespace BlackOS
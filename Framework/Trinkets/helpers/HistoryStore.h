@@ -0,0 +1,82 @@
+#ifndef TRINKETS_HISTORY_STORE_H
+#define TRINKETS_HISTORY_STORE_H
+
+/**
+ * HistoryStore
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <sys/file.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// persistent command history. commands are appended, one per line, to a
+/// log that is never rewritten. a second file holds the offset of every
+/// command in the log; both are mapped into memory, so opening the store
+/// costs the same for ten commands as for ten million. entries are numbered
+/// from 0, the oldest, and include those added by other shells up to the
+/// last sync().
+class HistoryStore {
+public:
+  int open(std::filesystem::path const &logPath);
+  int append(std::string const &command);
+  int sync();
+  size_t size() const;
+  std::string_view entry(size_t const idx) const;
+  long search(std::string_view const query, size_t const before) const;
+
+  ~HistoryStore();
+
+private:
+  struct IndexHeader {
+    char magic[8];
+    uint64_t logBytes; // log bytes that have been indexed
+    uint64_t entries;
+  };
+
+  int _indexTail();
+  int _mapLog(size_t const len);
+  int _mapIndex(size_t const len);
+  int _resetIndex();
+  long _search(std::string_view const query, size_t const entries) const;
+  int _lock(int const operation = LOCK_EX) const;
+  void _unlock() const;
+  bool _readable() const;
+  IndexHeader *_header() const;
+  uint64_t *_offsets() const;
+  size_t _capacity() const;
+  void _close();
+
+  int _logFd = -1;
+  int _indexFd = -1;
+  char const *_log = nullptr;
+  size_t _logMapped = 0;
+  char *_index = nullptr;
+  size_t _indexMapped = 0;
+  size_t _entries = 0;  // snapshot of the index header
+  size_t _logBytes = 0; // taken when last synced
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
@@ -0,0 +1,123 @@
+/**
+ * Job
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "Job.h"
+
+#include <cerrno>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// collect a change of state of the job's main process: exited, killed,
+/// stopped or continued. with block set, wait until there is one.
+JobState Job::update(bool const block) {
+  if (pid <= 0 || state == JobState::DONE)
+    return state;
+
+  int wstatus = 0;
+  pid_t got;
+  do {
+    got = waitpid(pid, &wstatus,
+                  (block ? 0 : WNOHANG) | WUNTRACED | WCONTINUED);
+  } while (got < 0 && errno == EINTR);
+
+  if (got < 0) {
+    // already reaped elsewhere
+    state = JobState::DONE;
+  } else if (got == pid) {
+    if (WIFEXITED(wstatus)) {
+      state = JobState::DONE;
+      status = WEXITSTATUS(wstatus);
+    } else if (WIFSIGNALED(wstatus)) {
+      state = JobState::DONE;
+      status = -1;
+    } else if (WIFSTOPPED(wstatus)) {
+      state = JobState::STOPPED;
+    } else if (WIFCONTINUED(wstatus)) {
+      state = JobState::RUNNING;
+    }
+  }
+  return state;
+}
+
+/// send sig to every process of the job.
+void Job::signal(int const sig) const {
+  if (pgid > 0)
+    killpg(pgid, sig);
+  else if (pid > 0)
+    kill(pid, sig);
+}
+
+/// continue a stopped job.
+void Job::resume() {
+  signal(SIGCONT);
+  state = JobState::RUNNING;
+}
+
+/// stop the job as ^Z would. a program that handles SIGTSTP gets graceMs to
+/// stop itself; after that, or if its process group is orphaned and the
+/// kernel discards SIGTSTP, it is stopped with SIGSTOP.
+void Job::suspend(int const graceMs) {
+  signal(SIGTSTP);
+  for (int waited = 0; waited < graceMs; waited += 2) {
+    if (update() != JobState::RUNNING)
+      return;
+    usleep(2000);
+  }
+  if (update() != JobState::RUNNING)
+    return;
+  signal(SIGSTOP);
+  while (update(true) == JobState::RUNNING)
+    ;
+}
+
+/// wait up to graceMs for the job to end, e.g. after it was interrupted,
+/// then kill it.
+void Job::reap(int const graceMs) {
+  for (int waited = 0; waited < graceMs; waited += 2) {
+    if (update() == JobState::DONE)
+      return;
+    usleep(2000);
+  }
+  if (update() == JobState::DONE)
+    return;
+  signal(SIGKILL);
+  signal(SIGCONT);
+  while (update(true) != JobState::DONE)
+    ;
+}
+
+/// the command as the user typed it.
+std::string Job::commandLine() const {
+  std::string line;
+  for (auto const &arg : argv) {
+    if (!line.empty())
+      line += ' ';
+    line += arg;
+  }
+  return line;
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
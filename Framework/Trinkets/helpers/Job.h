@@ -0,0 +1,67 @@
+#ifndef TRINKETS_JOB_H
+#define TRINKETS_JOB_H
+
+/**
+ * Job
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "CommandCapture.h"
+#include "PtySession.h"
+#include "Terminal.h"
+
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+enum class JobState { RUNNING, STOPPED, DONE };
+
+/// a command started by the shell. the command runs in a process group of
+/// its own, so signals sent to the job reach everything it has started. a
+/// job runs either on a pseudo-terminal, with its output captured, or with
+/// the real terminal handed to it.
+struct Job {
+public:
+  JobState update(bool const block = false);
+  void signal(int const sig) const;
+  void resume();
+  void suspend(int const graceMs);
+  void reap(int const graceMs);
+  std::string commandLine() const;
+
+  std::vector<std::string> argv;
+  // the same words, null-terminated, for exec. it points into storage owned
+  // by whoever starts the job and is only used while the job is started.
+  char *const *exec = nullptr;
+  pid_t pid = -1;
+  pid_t pgid = -1;
+  JobState state = JobState::RUNNING;
+  int status = -1; // exit status once DONE, -1 if killed by a signal
+
+  std::unique_ptr<PtySession> pty;
+  std::unique_ptr<DisplayKernel::Terminal> terminal;
+  std::unique_ptr<CommandCapture> capture;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
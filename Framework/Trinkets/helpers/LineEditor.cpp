@@ -0,0 +1,209 @@
+/**
+ * LineEditor
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "LineEditor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace BlackOS {
+namespace Trinkets {
+
+LineEditor::LineEditor(size_t const capacity)
+    : _buffer(capacity), _gapEnd(capacity) {}
+
+/// insert c at the cursor.
+void LineEditor::insert(char const c) { insert(std::string_view(&c, 1)); }
+
+/// insert text at the cursor.
+void LineEditor::insert(std::string_view const text) {
+  if (text.empty())
+    return;
+  _reserve(text.size());
+  _touch(_gapStart);
+  std::memcpy(_buffer.data() + _gapStart, text.data(), text.size());
+  _gapStart += text.size();
+}
+
+/// delete the character before the cursor.
+bool LineEditor::backspace() {
+  if (_gapStart == 0)
+    return false;
+  _erase(_gapStart - 1, _gapStart);
+  return true;
+}
+
+/// delete the character under the cursor.
+bool LineEditor::deleteForward() {
+  if (_gapStart == size())
+    return false;
+  _erase(_gapStart, _gapStart + 1);
+  return true;
+}
+
+/// delete the word before the cursor, and the spaces after it (^W).
+bool LineEditor::deleteWordBefore() {
+  size_t const to = _gapStart;
+  wordLeft();
+  if (_gapStart == to)
+    return false;
+  _erase(_gapStart, to);
+  return true;
+}
+
+/// delete from the start of the line to the cursor (^U).
+void LineEditor::killToStart() { _erase(0, _gapStart); }
+
+/// delete from the cursor to the end of the line (^K).
+void LineEditor::killToEnd() { _erase(_gapStart, size()); }
+
+/// replace the line with text and put the cursor at its end. only the part
+/// after the prefix the two lines share is marked to be redrawn.
+void LineEditor::assign(std::string_view const text) {
+  size_t same = 0;
+  size_t const oldSize = size();
+  while (same < oldSize && same < text.size() && at(same) == text[same])
+    ++same;
+  end();
+  _erase(same, oldSize);
+  insert(text.substr(same));
+}
+
+void LineEditor::clear() { _erase(0, size()); }
+
+bool LineEditor::left() {
+  if (_gapStart == 0)
+    return false;
+  _moveGap(_gapStart - 1);
+  return true;
+}
+
+bool LineEditor::right() {
+  if (_gapStart == size())
+    return false;
+  _moveGap(_gapStart + 1);
+  return true;
+}
+
+void LineEditor::home() { _moveGap(0); }
+
+void LineEditor::end() { _moveGap(size()); }
+
+/// move to the start of the word before the cursor.
+void LineEditor::wordLeft() {
+  size_t pos = _gapStart;
+  while (pos > 0 && std::isspace((unsigned char)at(pos - 1)))
+    --pos;
+  while (pos > 0 && !std::isspace((unsigned char)at(pos - 1)))
+    --pos;
+  _moveGap(pos);
+}
+
+/// move past the end of the word after the cursor.
+void LineEditor::wordRight() {
+  size_t pos = _gapStart;
+  size_t const len = size();
+  while (pos < len && std::isspace((unsigned char)at(pos)))
+    ++pos;
+  while (pos < len && !std::isspace((unsigned char)at(pos)))
+    ++pos;
+  _moveGap(pos);
+}
+
+void LineEditor::moveTo(size_t const pos) { _moveGap(std::min(pos, size())); }
+
+size_t LineEditor::size() const { return _buffer.size() - _gapSize(); }
+
+size_t LineEditor::cursor() const { return _gapStart; }
+
+char LineEditor::at(size_t const idx) const {
+  return idx < _gapStart ? _buffer[idx] : _buffer[idx + _gapSize()];
+}
+
+std::string LineEditor::text() const { return slice(0, size()); }
+
+/// the characters from position from up to, not including, to.
+std::string LineEditor::slice(size_t const from, size_t const to) const {
+  std::string out;
+  out.reserve(to - from);
+  if (from < _gapStart)
+    out.append(_buffer.data() + from, std::min(to, _gapStart) - from);
+  if (to > _gapStart) {
+    size_t const start = std::max(from, _gapStart);
+    out.append(_buffer.data() + start + _gapSize(), to - start);
+  }
+  return out;
+}
+
+/// the first position that changed since markDrawn(), or npos if none did.
+size_t LineEditor::dirtyFrom() const { return _dirty; }
+
+void LineEditor::markDrawn() { _dirty = npos; }
+
+/// have the line redrawn from position from, e.g. after something else was
+/// drawn over it.
+void LineEditor::invalidate(size_t const from) { _touch(from); }
+
+void LineEditor::_moveGap(size_t const pos) {
+  if (pos < _gapStart) {
+    size_t const n = _gapStart - pos;
+    std::memmove(_buffer.data() + _gapEnd - n, _buffer.data() + pos, n);
+    _gapStart -= n;
+    _gapEnd -= n;
+  } else if (pos > _gapStart) {
+    size_t const n = pos - _gapStart;
+    std::memmove(_buffer.data() + _gapStart, _buffer.data() + _gapEnd, n);
+    _gapStart += n;
+    _gapEnd += n;
+  }
+}
+
+/// make the gap at least extra long, doubling the buffer as needed.
+void LineEditor::_reserve(size_t const extra) {
+  if (_gapSize() >= extra)
+    return;
+  size_t const tail = _buffer.size() - _gapEnd;
+  size_t capacity = std::max<size_t>(_buffer.size() * 2, 16);
+  while (capacity - size() < extra)
+    capacity *= 2;
+  std::vector<char> grown(capacity);
+  std::memcpy(grown.data(), _buffer.data(), _gapStart);
+  std::memcpy(grown.data() + capacity - tail, _buffer.data() + _gapEnd, tail);
+  _buffer.swap(grown);
+  _gapEnd = capacity - tail;
+}
+
+/// delete positions [from, to); the cursor ends up at from.
+void LineEditor::_erase(size_t const from, size_t const to) {
+  if (from >= to)
+    return;
+  _moveGap(to);
+  _gapStart = from;
+  _touch(from);
+}
+
+void LineEditor::_touch(size_t const pos) { _dirty = std::min(_dirty, pos); }
+
+size_t LineEditor::_gapSize() const { return _gapEnd - _gapStart; }
+
+} // namespace Trinkets
+} // namespace BlackOS
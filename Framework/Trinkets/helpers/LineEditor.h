@@ -0,0 +1,83 @@
+#ifndef TRINKETS_LINE_EDITOR_H
+#define TRINKETS_LINE_EDITOR_H
+
+/**
+ * LineEditor
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// the line being typed at the prompt, kept in a gap buffer: the free space
+/// sits at the cursor, so typing and deleting there only move the gap. the
+/// editor remembers the first position changed since it was last drawn, so
+/// that only the rest of the line has to be redrawn.
+class LineEditor {
+public:
+  static constexpr size_t npos = std::string::npos;
+
+  explicit LineEditor(size_t const capacity = 256);
+
+  void insert(char const c);
+  void insert(std::string_view const text);
+  bool backspace();
+  bool deleteForward();
+  bool deleteWordBefore();
+  void killToStart();
+  void killToEnd();
+  void assign(std::string_view const text);
+  void clear();
+
+  bool left();
+  bool right();
+  void home();
+  void end();
+  void wordLeft();
+  void wordRight();
+  void moveTo(size_t const pos);
+
+  size_t size() const;
+  size_t cursor() const;
+  char at(size_t const idx) const;
+  std::string text() const;
+  std::string slice(size_t const from, size_t const to) const;
+  size_t dirtyFrom() const;
+  void markDrawn();
+  void invalidate(size_t const from = 0);
+
+private:
+  void _moveGap(size_t const pos);
+  void _reserve(size_t const extra);
+  void _erase(size_t const from, size_t const to);
+  void _touch(size_t const pos);
+  size_t _gapSize() const;
+
+  std::vector<char> _buffer;
+  size_t _gapStart = 0; // also the cursor
+  size_t _gapEnd;
+  size_t _dirty = npos; // first position changed since markDrawn()
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
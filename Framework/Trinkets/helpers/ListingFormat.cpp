@@ -0,0 +1,146 @@
+/**
+ * ListingFormat
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "ListingFormat.h"
+
+#include <cstring>
+#include <time.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+/// rwxrwxrwx for every value of the nine permission bits.
+struct PermissionTable {
+  char rows[512][10];
+
+  constexpr PermissionTable() : rows() {
+    for (size_t mode = 0; mode < 512; ++mode)
+      for (size_t i = 0; i < 9; ++i)
+        rows[mode][i] = mode & (0400 >> i) ? "rwx"[i % 3] : '-';
+  }
+};
+
+constexpr PermissionTable PERMISSIONS;
+
+int64_t const SECONDS_PER_DAY = 24 * 60 * 60;
+
+/// the UTC offset in force at time, or false if it cannot be told.
+bool offsetAt(int64_t const time, long &offset) {
+  time_t const t = time;
+  struct tm local;
+  if (localtime_r(&t, &local) == nullptr)
+    return false;
+  offset = local.tm_gmtoff;
+  return true;
+}
+} // namespace
+
+/// the permission bits of mode as rwxrwxrwx.
+char const *permissionString(uint16_t const mode) {
+  return PERMISSIONS.rows[mode & 0777];
+}
+
+/// add text to line, padded with spaces to width characters. characters
+/// are counted as code points, so names in UTF-8 line up.
+void appendColumn(std::string &line, std::string_view const text,
+                  size_t const width) {
+  size_t length = text.size();
+  for (unsigned char const c : text)
+    length -= (c & 0xc0) == 0x80; // continuation bytes
+  line.append(text);
+  if (length < width)
+    line.append(width - length, ' ');
+}
+
+/// write time into out, which must hold MAX_LENGTH bytes, without a NUL.
+/// returns the length written, or 0 if the time cannot be shown.
+size_t DateFormatter::format(int64_t const time, char *out) {
+  int64_t const day = time >= 0 ? time / SECONDS_PER_DAY
+                                : (time + 1) / SECONDS_PER_DAY - 1;
+  Span &span = _spans[static_cast<uint64_t>(day) % _SPANS];
+  if ((time < span.from || time >= span.to) && !_cache(time, span))
+    return 0;
+
+  int const minute = span.fromMinute + (time - span.from) / 60;
+  std::memcpy(out, span.date, span.dateLength);
+  char *at = out + span.dateLength;
+  *at++ = '0' + minute / 600;
+  *at++ = '0' + minute / 60 % 10;
+  *at++ = ':';
+  *at++ = '0' + minute % 60 / 10;
+  *at++ = '0' + minute % 10;
+  std::memcpy(at, span.zone, span.zoneLength);
+  return at + span.zoneLength - out;
+}
+
+std::string DateFormatter::format(int64_t const time) {
+  char buffer[MAX_LENGTH];
+  return std::string(buffer, format(time, buffer));
+}
+
+/// work out the span time falls in. returns false if localtime_r cannot
+/// place it.
+bool DateFormatter::_cache(int64_t const time, Span &span) {
+  time_t const t = time;
+  struct tm local;
+  if (localtime_r(&t, &local) == nullptr)
+    return false;
+  size_t const dateLength =
+      strftime(span.date, sizeof(span.date), "%d-%m-%Y ", &local);
+  size_t const zoneLength =
+      strftime(span.zone, sizeof(span.zone), "  %Z", &local);
+  if (dateLength == 0 || zoneLength == 0) {
+    span.from = 1;
+    span.to = 0;
+    return false;
+  }
+  span.dateLength = dateLength;
+  span.zoneLength = zoneLength;
+
+  // the day, or failing that the hour or the minute, over which the
+  // offset holds.
+  int64_t const intoMinute = local.tm_sec;
+  int64_t const intoHour = local.tm_min * 60 + intoMinute;
+  int64_t const intoDay = local.tm_hour * 3600 + intoHour;
+  long const offset = local.tm_gmtoff;
+  auto const holds = [offset](int64_t const from, int64_t const to) {
+    long first, last;
+    return offsetAt(from, first) && offsetAt(to - 1, last) &&
+           first == offset && last == offset;
+  };
+  span.from = time - intoDay;
+  span.to = span.from + SECONDS_PER_DAY;
+  if (!holds(span.from, span.to)) {
+    span.from = time - intoHour;
+    span.to = span.from + 3600;
+    if (!holds(span.from, span.to)) {
+      span.from = time - intoMinute;
+      span.to = span.from + 60;
+    }
+  }
+  span.fromMinute = local.tm_hour * 60 + local.tm_min -
+                    static_cast<int>((time - intoMinute - span.from) / 60);
+  return true;
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
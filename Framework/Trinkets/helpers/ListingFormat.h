@@ -0,0 +1,70 @@
+#ifndef TRINKETS_LISTING_FORMAT_H
+#define TRINKETS_LISTING_FORMAT_H
+
+/**
+ * ListingFormat
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace BlackOS {
+namespace Trinkets {
+
+char const *permissionString(uint16_t const mode);
+void appendColumn(std::string &line, std::string_view const text,
+                  size_t const width);
+
+/// writes times as listings show them, e.g. 19-10-2026 10:08  UTC, in local
+/// time. the date, the zone and the minute of the day a time falls on are
+/// worked out with localtime_r and kept for as long as they hold, which is
+/// until the end of that day or a change of UTC offset, whichever comes
+/// first. a time in a span already kept only needs its hours and minutes
+/// written; the children of a directory mostly share a few days.
+class DateFormatter {
+public:
+  static size_t const MAX_LENGTH = 64;
+
+  size_t format(int64_t const time, char *out);
+  std::string format(int64_t const time);
+
+private:
+  /// a stretch of time with one date and one UTC offset.
+  struct Span {
+    int64_t from = 1; // [from, to); empty to begin with
+    int64_t to = 0;
+    int fromMinute = 0; // the minute of the day at from
+    uint8_t dateLength = 0;
+    uint8_t zoneLength = 0;
+    char date[24]; // "dd-mm-yyyy "
+    char zone[24]; // "  UTC"
+  };
+
+  static bool _cache(int64_t const time, Span &span);
+
+  static size_t const _SPANS = 256; // by UTC day
+  std::array<Span, _SPANS> _spans;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
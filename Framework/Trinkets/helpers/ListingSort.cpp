@@ -0,0 +1,332 @@
+/**
+ * ListingSort
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "ListingSort.h"
+#include "PathController.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <endian.h>
+#include <string>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+char const *const ORDER_NAMES[SORT_ORDERS] = {"name", "natural", "mtime",
+                                              "size", "type"};
+
+// below this many, a bucket is finished by insertion sort.
+size_t const SMALL_BUCKET = 32;
+
+/// the sort keys of every name, packed into one buffer. a key is the name
+/// folded to lower case; a natural key also replaces each run of digits
+/// with '0', the count of its significant digits and the digits, so that
+/// comparing keys byte by byte compares the numbers.
+class CollationKeys {
+public:
+  CollationKeys(PathEntries const &entries, bool const natural) {
+    // the names with their NULs dropped.
+    size_t const total = entries.names.size() - entries.size();
+    _spans.reserve(entries.size());
+    if (!natural) {
+      _bytes.resize(total);
+      char *out = _bytes.data();
+      for (size_t i = 0; i < entries.size(); ++i) {
+        std::string_view const name = entries.name(i);
+        _spans.push_back({static_cast<uint32_t>(out - _bytes.data()),
+                          static_cast<uint32_t>(name.size())});
+        for (unsigned char const c : name)
+          *out++ = fold(c);
+      }
+      return;
+    }
+    _bytes.reserve(total + total / 2);
+    for (size_t i = 0; i < entries.size(); ++i) {
+      uint32_t const start = _bytes.size();
+      _appendNatural(entries.name(i));
+      _spans.push_back({start, static_cast<uint32_t>(_bytes.size() - start)});
+    }
+  }
+
+  /// the eight bytes of key idx from depth, big-endian and padded with
+  /// zeros. no key holds a zero byte, so a key that ends sorts first.
+  uint64_t prefix(uint32_t const idx, size_t const depth) const {
+    Span const &span = _spans[idx];
+    char bytes[8] = {};
+    if (depth < span.len)
+      std::memcpy(bytes, _bytes.data() + span.start + depth,
+                  std::min<size_t>(8, span.len - depth));
+    uint64_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return be64toh(value);
+  }
+
+  /// compare keys a and b from depth on.
+  bool less(uint32_t const a, uint32_t const b, size_t const depth) const {
+    Span const &x = _spans[a];
+    Span const &y = _spans[b];
+    size_t const len = std::min(x.len, y.len);
+    if (depth < len) {
+      int const cmp = std::memcmp(_bytes.data() + x.start + depth,
+                                  _bytes.data() + y.start + depth, len - depth);
+      if (cmp != 0)
+        return cmp < 0;
+    }
+    return x.len < y.len;
+  }
+
+private:
+  struct Span {
+    uint32_t start;
+    uint32_t len;
+  };
+
+  static char fold(unsigned char const c) {
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+  }
+
+  void _appendNatural(std::string_view const name) {
+    for (size_t i = 0; i < name.size();) {
+      if (name[i] < '0' || name[i] > '9') {
+        _bytes.push_back(fold(name[i++]));
+        continue;
+      }
+      while (i + 1 < name.size() && name[i] == '0' && name[i + 1] >= '0' &&
+             name[i + 1] <= '9')
+        ++i; // leading zeros do not count
+      size_t const begin = i;
+      while (i < name.size() && name[i] >= '0' && name[i] <= '9')
+        ++i;
+      _bytes.push_back('0');
+      _bytes.push_back(static_cast<char>(std::min<size_t>(i - begin, 255)));
+      _bytes.append(name.substr(begin, i - begin));
+    }
+  }
+
+  std::string _bytes;
+  std::vector<Span> _spans;
+};
+
+/// an index with the next sixteen bytes of its key, which for most names
+/// is the rest of it, so the sort reads memory in order rather than chasing
+/// each key.
+struct Item {
+  uint64_t prefix[2];
+  uint32_t idx;
+
+  void load(CollationKeys const &keys, size_t const depth) {
+    prefix[0] = keys.prefix(idx, depth);
+    prefix[1] = keys.prefix(idx, depth + 8);
+  }
+  unsigned at(unsigned const byte) const {
+    return (prefix[byte / 8] >> (56 - 8 * (byte % 8))) & 0xff;
+  }
+};
+
+size_t const PREFIX_BYTES = sizeof(Item::prefix);
+
+/// insertion sort of a few items, whose keys agree before depth.
+void insertionSort(CollationKeys const &keys, Item *items, size_t const count,
+                   size_t const depth) {
+  for (size_t i = 1; i < count; ++i) {
+    Item const item = items[i];
+    size_t j = i;
+    for (; j > 0; --j) {
+      Item const &before = items[j - 1];
+      if (item.prefix[0] != before.prefix[0]) {
+        if (item.prefix[0] > before.prefix[0])
+          break;
+      } else if (item.prefix[1] != before.prefix[1]) {
+        if (item.prefix[1] > before.prefix[1])
+          break;
+      } else if (!keys.less(item.idx, before.idx, depth + PREFIX_BYTES)) {
+        break;
+      }
+      items[j] = before;
+    }
+    items[j] = item;
+  }
+}
+
+/// sort the items in from, whose keys agree before depth, leaving them in
+/// from or, if intoOther, in other. a stable counting pass on each byte of
+/// the prefix in turn moves them from one array to the other, then each
+/// bucket of equal prefixes is sorted on the sixteen bytes after. small
+/// buckets are finished by insertion sort.
+void msdSort(CollationKeys const &keys, Item *from, Item *other,
+             size_t const count, size_t const depth, unsigned const byte,
+             bool const intoOther) {
+  if (count < SMALL_BUCKET) {
+    insertionSort(keys, from, count, depth);
+    if (intoOther)
+      std::copy(from, from + count, other);
+    return;
+  }
+
+  std::array<size_t, 257> bucket{};
+  for (size_t i = 0; i < count; ++i)
+    ++bucket[from[i].at(byte) + 1];
+  for (size_t b = 1; b < bucket.size(); ++b)
+    bucket[b] += bucket[b - 1];
+  std::array<size_t, 257> const start = bucket;
+
+  unsigned const shared = from[0].at(byte);
+  if (start[shared + 1] - start[shared] == count) {
+    // every item has the same byte here; there is nothing to move.
+    if (shared == 0) {
+      if (intoOther)
+        std::copy(from, from + count, other);
+      return;
+    }
+    if (byte + 1 < PREFIX_BYTES)
+      return msdSort(keys, from, other, count, depth, byte + 1, intoOther);
+    for (size_t i = 0; i < count; ++i)
+      from[i].load(keys, depth + PREFIX_BYTES);
+    return msdSort(keys, from, other, count, depth + PREFIX_BYTES, 0,
+                   intoOther);
+  }
+
+  for (size_t i = 0; i < count; ++i)
+    other[bucket[from[i].at(byte)]++] = from[i];
+
+  // the items are now in other; each bucket is finished where the caller
+  // wants it. bucket 0 holds keys that have ended, which are equal.
+  for (size_t b = 0; b < 256; ++b) {
+    size_t const size = start[b + 1] - start[b];
+    Item *const here = other + start[b];
+    Item *const there = from + start[b];
+    if (b == 0 || size <= 1) {
+      if (!intoOther)
+        std::copy(here, here + size, there);
+      continue;
+    }
+    if (byte + 1 < PREFIX_BYTES) {
+      msdSort(keys, here, there, size, depth, byte + 1, !intoOther);
+      continue;
+    }
+    for (size_t i = 0; i < size; ++i)
+      here[i].load(keys, depth + PREFIX_BYTES);
+    msdSort(keys, here, there, size, depth + PREFIX_BYTES, 0, !intoOther);
+  }
+}
+
+/// stable sort of order by value, a byte at a time from the lowest. the
+/// values travel with the indices, and bytes every value shares are skipped.
+void lsdSort(std::vector<uint32_t> &order,
+             std::vector<uint64_t> const &values) {
+  struct Keyed {
+    uint64_t value;
+    uint32_t idx;
+  };
+  std::vector<Keyed> keyed(order.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    keyed[i] = {values[order[i]], order[i]};
+  std::vector<Keyed> scratch(keyed.size());
+
+  for (unsigned shift = 0; shift < 64; shift += 8) {
+    std::array<size_t, 257> bucket{};
+    for (Keyed const &item : keyed)
+      ++bucket[((item.value >> shift) & 0xff) + 1];
+    if (bucket[((keyed[0].value >> shift) & 0xff) + 1] == keyed.size())
+      continue;
+    for (size_t b = 1; b < bucket.size(); ++b)
+      bucket[b] += bucket[b - 1];
+    for (Keyed const &item : keyed)
+      scratch[bucket[(item.value >> shift) & 0xff]++] = item;
+    keyed.swap(scratch);
+  }
+
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = keyed[i].idx;
+}
+
+std::vector<uint32_t> byKey(PathEntries const &entries, bool const natural) {
+  CollationKeys const keys(entries, natural);
+  std::vector<Item> items(entries.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    items[i].idx = i;
+    items[i].load(keys, 0);
+  }
+  std::vector<Item> scratch(items.size());
+  if (!items.empty())
+    msdSort(keys, items.data(), scratch.data(), items.size(), 0, 0, false);
+
+  std::vector<uint32_t> order(items.size());
+  for (size_t i = 0; i < items.size(); ++i)
+    order[i] = items[i].idx;
+  return order;
+}
+} // namespace
+
+char const *sortOrderName(SortOrder const order) {
+  return ORDER_NAMES[static_cast<size_t>(order)];
+}
+
+/// set order from its name. returns 0, or -1 if no order has that name.
+int parseSortOrder(std::string_view const name, SortOrder &order) {
+  for (size_t i = 0; i < SORT_ORDERS; ++i) {
+    if (name == ORDER_NAMES[i]) {
+      order = static_cast<SortOrder>(i);
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/// true if every entry must be statted before sorting. the type order only
+/// needs the types the directory did not report.
+bool sortNeedsMetadata(SortOrder const order) {
+  return order == SortOrder::MTIME || order == SortOrder::SIZE;
+}
+
+/// the indices of entries in the given order. names are turned into sort
+/// keys once and the indices sorted by radix on those keys; the other orders
+/// then sort the name order by a number, keeping names in order for ties.
+std::vector<uint32_t> sortListing(PathEntries const &entries,
+                                  SortOrder const order) {
+  std::vector<uint32_t> sorted = byKey(entries, order == SortOrder::NATURAL);
+  if (order == SortOrder::NAME || order == SortOrder::NATURAL ||
+      sorted.empty())
+    return sorted;
+
+  // each order reads one column from start to end.
+  std::vector<uint64_t> values(entries.size());
+  if (order == SortOrder::MTIME && entries.hasMetadata()) {
+    // flipping the sign bit orders signed times as unsigned values.
+    for (size_t i = 0; i < entries.size(); ++i)
+      values[i] = ~(static_cast<uint64_t>(entries.mtimes[i]) ^ (1ull << 63));
+  } else if (order == SortOrder::SIZE && entries.hasMetadata()) {
+    for (size_t i = 0; i < entries.size(); ++i)
+      values[i] = ~entries.sizes[i]; // largest and newest first
+  } else if (order == SortOrder::TYPE) {
+    for (size_t i = 0; i < entries.size(); ++i)
+      values[i] = entries.types[i] == PathType::DIRECTORY ? 0
+                  : entries.types[i] == PathType::FILE    ? 1
+                                                          : 2;
+  }
+  lsdSort(sorted, values);
+  return sorted;
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,49 @@
+#ifndef TRINKETS_LISTING_SORT_H
+#define TRINKETS_LISTING_SORT_H
+
+/**
+ * ListingSort
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+struct PathEntries;
+
+/// the orders a listing can be shown in. names compare ignoring case; the
+/// natural order also compares runs of digits as numbers, so file9 comes
+/// before file10. the newest and the largest come first, ties by name.
+enum class SortOrder : uint8_t { NAME, NATURAL, MTIME, SIZE, TYPE };
+
+size_t const SORT_ORDERS = 5;
+
+char const *sortOrderName(SortOrder const order);
+int parseSortOrder(std::string_view const name, SortOrder &order);
+bool sortNeedsMetadata(SortOrder const order);
+
+std::vector<uint32_t> sortListing(PathEntries const &entries,
+                                  SortOrder const order);
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
@@ -0,0 +1,287 @@
+/**
+ * MetadataFetcher
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "MetadataFetcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <memory>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+unsigned const STATX_WANTED =
+    STATX_TYPE | STATX_MODE | STATX_MTIME | STATX_SIZE;
+
+int ioUringSetup(unsigned const entries, io_uring_params *params) {
+  return static_cast<int>(syscall(SYS_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int const fd, unsigned const toSubmit,
+                 unsigned const minComplete, unsigned const flags) {
+  return static_cast<int>(syscall(SYS_io_uring_enter, fd, toSubmit,
+                                  minComplete, flags, nullptr, 0));
+}
+
+PathType typeFromMode(uint16_t const mode) {
+  if (S_ISDIR(mode))
+    return PathType::DIRECTORY;
+  if (S_ISREG(mode))
+    return PathType::FILE;
+  return PathType::OTHER;
+}
+} // namespace
+
+MetadataFetcher::MetadataFetcher() {
+  if (_setupRing() != 0)
+    _closeRing();
+}
+
+MetadataFetcher::~MetadataFetcher() { _closeRing(); }
+
+/// true if requests go through io_uring rather than worker threads.
+bool MetadataFetcher::usingRing() const { return _ringFd >= 0; }
+
+/// record the result of a statx in entry idx, whose metadata columns must
+/// have been made; a null result means it failed.
+void MetadataFetcher::apply(PathEntries &entries, size_t const idx,
+                            struct statx const *st) {
+  if (st == nullptr) {
+    entries.flags[idx] |= PathEntries::STATTED | PathEntries::MISSING;
+    return;
+  }
+  entries.flags[idx] |= PathEntries::STATTED;
+  entries.types[idx] = typeFromMode(st->stx_mode);
+  entries.modes[idx] = st->stx_mode & 0777;
+  entries.mtimes[idx] = st->stx_mtime.tv_sec;
+  entries.sizes[idx] = st->stx_size;
+}
+
+/// statx every entry listed in indices, relative to dirFd, following links.
+void MetadataFetcher::fetch(int const dirFd, PathEntries &entries,
+                            std::vector<size_t> const &indices) {
+  if (indices.empty())
+    return;
+  entries.makeMetadata();
+  if (usingRing())
+    _fetchRing(dirFd, entries, indices);
+  else
+    _fetchThreads(dirFd, entries, indices);
+}
+
+/// set up a ring and map its queues. returns 0, or -1 if the kernel does
+/// not offer io_uring, or not its statx.
+int MetadataFetcher::_setupRing() {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  _ringFd = ioUringSetup(RING_ENTRIES, &params);
+  if (_ringFd < 0)
+    return -1;
+  // kernels old enough to lack statx on the ring (before 5.6) answer it
+  // with -EINVAL; _complete() falls back to a direct call for those.
+  if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+    return -1;
+
+  _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  _cqRingSize =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // the two queues share one mapping.
+  _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+  _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+  if (_sqRing == MAP_FAILED) {
+    _sqRing = nullptr;
+    return -1;
+  }
+  _cqRing = _sqRing;
+
+  _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  void *const sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    return -1;
+  _sqes = static_cast<io_uring_sqe *>(sqes);
+
+  char *const sq = static_cast<char *>(_sqRing);
+  _sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  _sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  _sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  _sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  char *const cq = static_cast<char *>(_cqRing);
+  _cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  _cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  _cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  _cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  return 0;
+}
+
+/// keep the ring full: queue as many statx as there are free slots, submit
+/// them in one call, and take whatever has completed, until all are done.
+void MetadataFetcher::_fetchRing(int const dirFd, PathEntries &entries,
+                                 std::vector<size_t> const &indices) {
+  // a result buffer per slot; a slot is reused once its request completes.
+  std::unique_ptr<struct statx[]> results(new struct statx[RING_ENTRIES]);
+  std::vector<unsigned> freeSlots(RING_ENTRIES);
+  for (unsigned i = 0; i < RING_ENTRIES; ++i)
+    freeSlots[i] = RING_ENTRIES - 1 - i;
+
+  size_t next = 0;
+  size_t done = 0;
+  while (done < indices.size()) {
+    unsigned tail = *_sqTail;
+    unsigned const mask = *_sqMask;
+    while (next < indices.size() && !freeSlots.empty() &&
+           tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) < RING_ENTRIES) {
+      unsigned const slot = freeSlots.back();
+      freeSlots.pop_back();
+      size_t const idx = indices[next++];
+
+      io_uring_sqe &sqe = _sqes[tail & mask];
+      std::memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = IORING_OP_STATX;
+      sqe.fd = dirFd;
+      sqe.addr = reinterpret_cast<uintptr_t>(entries.cName(idx));
+      sqe.len = STATX_WANTED;
+      sqe.off = reinterpret_cast<uintptr_t>(&results[slot]);
+      sqe.statx_flags = AT_STATX_SYNC_AS_STAT;
+      sqe.user_data = (static_cast<uint64_t>(idx) << 16) | slot;
+      _sqArray[tail & mask] = tail & mask;
+      ++tail;
+    }
+    __atomic_store_n(_sqTail, tail, __ATOMIC_RELEASE);
+
+    // submit everything the kernel has not taken yet, which includes what
+    // was left by a call that failed with EAGAIN or EBUSY.
+    unsigned const pending =
+        tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+    int const entered =
+        ioUringEnter(_ringFd, pending, 1, IORING_ENTER_GETEVENTS);
+    if (entered < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      // the ring has stopped working; finish without it. requests already
+      // taken by the kernel may still write into results, so wait for them.
+      break;
+    }
+
+    unsigned head = *_cqHead;
+    unsigned const cqMask = *_cqMask;
+    while (head != __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE)) {
+      io_uring_cqe const &cqe = _cqes[head & cqMask];
+      unsigned const slot = cqe.user_data & 0xffff;
+      _complete(dirFd, entries, cqe.user_data >> 16, cqe.res, &results[slot]);
+      freeSlots.push_back(slot);
+      ++done;
+      ++head;
+    }
+    __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+  }
+
+  if (done < indices.size()) {
+    // requests are taken from the queue in order. reap those the kernel
+    // took before their buffers go away, then do the rest on threads.
+    size_t const submitted =
+        next - (*_sqTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE));
+    size_t const inFlight = submitted - done;
+    for (size_t reaped = 0; reaped < inFlight;) {
+      ioUringEnter(_ringFd, 0, 1, IORING_ENTER_GETEVENTS);
+      unsigned head = *_cqHead;
+      while (head != __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE)) {
+        io_uring_cqe const &cqe = _cqes[head & *_cqMask];
+        _complete(dirFd, entries, cqe.user_data >> 16, cqe.res,
+                  &results[cqe.user_data & 0xffff]);
+        ++head;
+        ++reaped;
+      }
+      __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+    }
+    _closeRing();
+    std::vector<size_t> const rest(indices.begin() + submitted,
+                                   indices.end());
+    _fetchThreads(dirFd, entries, rest);
+  }
+}
+
+/// record a completed request. a statx of a name read from the directory
+/// is never invalid, so -EINVAL means the kernel cannot run it on the ring.
+void MetadataFetcher::_complete(int const dirFd, PathEntries &entries,
+                                size_t const idx, int res,
+                                struct statx *result) {
+  if (res == -EINVAL)
+    res = statx(dirFd, entries.cName(idx), AT_STATX_SYNC_AS_STAT,
+                STATX_WANTED, result);
+  apply(entries, idx, res == 0 ? result : nullptr);
+}
+
+/// share the entries between worker threads, each taking the next block of
+/// indices until none are left.
+void MetadataFetcher::_fetchThreads(int const dirFd, PathEntries &entries,
+                                    std::vector<size_t> const &indices) {
+  size_t const blockSize = 64;
+  std::atomic<size_t> nextBlock(0);
+  auto const work = [&]() {
+    struct statx st;
+    size_t begin;
+    while ((begin = nextBlock.fetch_add(blockSize)) < indices.size()) {
+      size_t const end = std::min(begin + blockSize, indices.size());
+      for (size_t i = begin; i < end; ++i) {
+        size_t const idx = indices[i];
+        bool const ok = statx(dirFd, entries.cName(idx), AT_STATX_SYNC_AS_STAT,
+                              STATX_WANTED, &st) == 0;
+        apply(entries, idx, ok ? &st : nullptr);
+      }
+    }
+  };
+
+  // statx mostly waits on the disk, so more threads than cores still help.
+  size_t const wanted = (indices.size() + blockSize - 1) / blockSize;
+  size_t const count = std::min<size_t>(
+      wanted, std::max(4u, 2 * std::thread::hardware_concurrency()));
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < count; ++i)
+    workers.emplace_back(work);
+  work();
+  for (auto &worker : workers)
+    worker.join();
+}
+
+void MetadataFetcher::_closeRing() {
+  if (_sqes != nullptr)
+    munmap(_sqes, _sqesSize);
+  if (_sqRing != nullptr)
+    munmap(_sqRing, _sqRingSize);
+  if (_ringFd >= 0)
+    ::close(_ringFd);
+  _sqes = nullptr;
+  _sqRing = _cqRing = nullptr;
+  _ringFd = -1;
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
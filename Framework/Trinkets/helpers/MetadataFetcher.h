@@ -0,0 +1,89 @@
+#ifndef TRINKETS_METADATA_FETCHER_H
+#define TRINKETS_METADATA_FETCHER_H
+
+/**
+ * MetadataFetcher
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "PathController.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct statx;
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// fills in the metadata of many directory entries at once. the statx calls
+/// are queued on an io_uring, so the kernel can have many of them waiting
+/// on the disk together rather than one after another; where io_uring is
+/// not available they are shared between worker threads. results arrive in
+/// any order and are written straight into the entries.
+class MetadataFetcher {
+public:
+  MetadataFetcher();
+  MetadataFetcher(MetadataFetcher const &) = delete;
+  MetadataFetcher &operator=(MetadataFetcher const &) = delete;
+  ~MetadataFetcher();
+
+  void fetch(int const dirFd, PathEntries &entries,
+             std::vector<size_t> const &indices);
+  bool usingRing() const;
+
+  static void apply(PathEntries &entries, size_t const idx,
+                    struct statx const *st);
+
+private:
+  static unsigned const RING_ENTRIES = 256;
+
+  int _setupRing();
+  void _fetchRing(int const dirFd, PathEntries &entries,
+                  std::vector<size_t> const &indices);
+  void _fetchThreads(int const dirFd, PathEntries &entries,
+                     std::vector<size_t> const &indices);
+  void _complete(int const dirFd, PathEntries &entries, size_t const idx,
+                 int res, struct statx *result);
+  void _closeRing();
+
+  int _ringFd = -1;
+  void *_sqRing = nullptr;
+  void *_cqRing = nullptr;
+  size_t _sqRingSize = 0;
+  size_t _cqRingSize = 0;
+  io_uring_sqe *_sqes = nullptr;
+  size_t _sqesSize = 0;
+
+  // views into the mapped rings
+  unsigned *_sqHead = nullptr;
+  unsigned *_sqTail = nullptr;
+  unsigned *_sqMask = nullptr;
+  unsigned *_sqArray = nullptr;
+  unsigned *_cqHead = nullptr;
+  unsigned *_cqTail = nullptr;
+  unsigned *_cqMask = nullptr;
+  io_uring_cqe *_cqes = nullptr;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
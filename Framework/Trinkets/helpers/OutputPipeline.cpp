@@ -0,0 +1,91 @@
+/**
+ * OutputPipeline
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "OutputPipeline.h"
+
+#include <algorithm>
+
+namespace BlackOS {
+namespace Trinkets {
+
+OutputPipeline::OutputPipeline(std::deque<std::string> &scrollback,
+                               size_t const maxScrollback,
+                               size_t const screenLines,
+                               int const framesPerSecond)
+    : _scrollback(scrollback), _maxScrollback(maxScrollback),
+      _screenLines(std::max<size_t>(screenLines, 1)),
+      _frameInterval(std::chrono::microseconds(
+          1000000 / std::max(framesPerSecond, 1))),
+      _lastFrame(clock::now() - _frameInterval) {}
+
+/// queue a line for the next frame. once more than a screenful is waiting,
+/// the oldest line is dropped from the frame; it stays in the scrollback.
+void OutputPipeline::push(std::string const &line) {
+  if (_maxScrollback > 0) {
+    if (_scrollback.size() >= _maxScrollback)
+      _scrollback.pop_front();
+    _scrollback.push_back(line);
+  }
+
+  _pending.push_back(line);
+  if (_pending.size() > _screenLines) {
+    _pending.pop_front();
+    ++_skipped;
+  }
+}
+
+/// true if there are lines waiting and a frame interval has passed.
+bool OutputPipeline::due() const {
+  return !_pending.empty() && clock::now() - _lastFrame >= _frameInterval;
+}
+
+/// milliseconds until the next frame may be drawn, for use as a poll
+/// timeout. -1 when nothing is waiting to be drawn.
+int OutputPipeline::msUntilFrame() const {
+  if (_pending.empty())
+    return -1;
+  auto const left = _frameInterval - (clock::now() - _lastFrame);
+  if (left <= clock::duration::zero())
+    return 0;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(left).count() +
+         1;
+}
+
+/// hand the waiting lines, and the number of lines skipped since the last
+/// frame, to renderer.
+void OutputPipeline::render(frame_renderer const &renderer) {
+  if (!_pending.empty() || _skipped > 0)
+    renderer(_pending, _skipped);
+  _pending.clear();
+  _skipped = 0;
+  _lastFrame = clock::now();
+}
+
+/// drop everything waiting to be drawn. the scrollback is kept.
+void OutputPipeline::discard() {
+  _pending.clear();
+  _skipped = 0;
+}
+
+size_t OutputPipeline::pending() const { return _pending.size(); }
+
+} // namespace Trinkets
+} // namespace BlackOS
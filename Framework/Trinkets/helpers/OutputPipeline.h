@@ -0,0 +1,63 @@
+#ifndef TRINKETS_OUTPUT_PIPELINE_H
+#define TRINKETS_OUTPUT_PIPELINE_H
+
+/**
+ * OutputPipeline
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// buffers captured lines between frames. every line is kept in the
+/// scrollback, but only the last screenful of lines waiting to be drawn is
+/// rendered, and no more than framesPerSecond times a second.
+struct OutputPipeline {
+public:
+  typedef std::chrono::steady_clock clock;
+  typedef std::function<void(std::deque<std::string> const &, size_t)>
+      frame_renderer;
+
+  OutputPipeline(std::deque<std::string> &scrollback, size_t const maxScrollback,
+                 size_t const screenLines, int const framesPerSecond);
+
+  void push(std::string const &line);
+  bool due() const;
+  int msUntilFrame() const;
+  void render(frame_renderer const &renderer);
+  void discard();
+  size_t pending() const;
+
+private:
+  std::deque<std::string> &_scrollback;
+  std::deque<std::string> _pending;
+  size_t _maxScrollback;
+  size_t _screenLines;
+  size_t _skipped = 0;
+  clock::duration _frameInterval;
+  clock::time_point _lastFrame;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
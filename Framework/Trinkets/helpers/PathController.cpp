@@ -20,24 +20,24 @@
  */
 
 #include "PathController.h"
+#include "DirectoryCache.h"
+#include "DirectoryReader.h"
+#include "MetadataFetcher.h"
 
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
+#include <dirent.h>
 #include <fcntl.h>
 #include <filesystem>
 #include <fmt/format.h>
-#include <fstream>
-#include <iomanip>
-#include <iostream>
-#include <list>
-#include <sstream>
-#include <stdio.h>
 #include <string>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
-#include <sys/wait.h>
+#include <system_error>
 #include <time.h>
 #include <unistd.h>
 #include <vector>
@@ -45,133 +45,451 @@
 namespace BlackOS {
 namespace Trinkets {
 
-std::string PathController::stripSubstring(std::string str,
-                                           std::string const &substring) {
-  size_t pos = std::string::npos;
-  // Search for the substring in string in a loop untill nothing is found
-  while ((pos = str.find(substring)) != std::string::npos) {
-    // If found then erase it from string
-    str.erase(pos, substring.length());
-  }
-  return str;
-}
+namespace {
+// the record getdents64 fills in; glibc only declares it for readdir.
+struct linux_dirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+} // namespace
+
+PathController::PathController(DirectoryCache *cache) : _cache(cache) {}
+
+PathController::~PathController() { _stopReading(); }
 
 std::string PathController::timestampToDateTime(time_t const rawtime) {
-  struct tm *dt;
-  char buffer[80];
-  dt = localtime(&rawtime);
-  strftime(buffer, sizeof(buffer), "%d-%m-%Y %H:%M  %Z", dt);
-  return std::string(buffer);
+  return _dates.format(rawtime);
 }
 
-std::string PathController::pathLastModifiedDate(std::string const &path) {
-  struct stat modResult;
-  if (stat(path.c_str(), &modResult) == 0) {
-    return timestampToDateTime(modResult.st_mtime);
-  } else {
+/// the name shown for a type in listings.
+char const *PathController::typeName(PathType const type) {
+  switch (type) {
+  case PathType::DIRECTORY:
+    return "directory";
+  case PathType::FILE:
+    return "file";
+  default:
     return "unknown";
   }
 }
 
-std::string PathController::pathPermissions(std::string const &path) {
-  namespace fs = std::filesystem;
-  fs::perms p = fs::status(path).permissions();
+std::filesystem::path PathController::parentPathObj() const {
+  return _listing ? _listing->path : std::filesystem::path();
+}
 
-  std::string uR = (p & fs::perms::owner_read) != fs::perms::none ? "r" : "-";
-  std::string uW = (p & fs::perms::owner_write) != fs::perms::none ? "w" : "-";
-  std::string uX = (p & fs::perms::owner_exec) != fs::perms::none ? "x" : "-";
+size_t PathController::childrenSize() const { return _shown.size(); }
 
-  std::string gR = (p & fs::perms::group_read) != fs::perms::none ? "r" : "-";
-  std::string gW = (p & fs::perms::group_write) != fs::perms::none ? "w" : "-";
-  std::string gX = (p & fs::perms::group_exec) != fs::perms::none ? "x" : "-";
+std::filesystem::path PathController::childPath(size_t const idx) const {
+  return _listing->path / _listing->entries.name(_shown[idx]);
+}
 
-  std::string oR = (p & fs::perms::others_read) != fs::perms::none ? "r" : "-";
-  std::string oW = (p & fs::perms::others_write) != fs::perms::none ? "w" : "-";
-  std::string oX = (p & fs::perms::others_exec) != fs::perms::none ? "x" : "-";
+/// the name of a child, good until another directory is loaded.
+std::string_view PathController::name(size_t const idx) const {
+  return _listing->entries.name(_shown[idx]);
+}
 
-  return uR + uW + uX + gR + gW + gX + oR + oW + oX;
+/// the type of a child. the directory usually reports it; only links and
+/// filesystems that do not cost a statx.
+PathType PathController::type(size_t const idx) {
+  uint32_t const child = _shown[idx];
+  PathEntries const &entries = _listing->entries;
+  if (entries.types[child] == PathType::UNKNOWN && !entries.statted(child))
+    _listing->stat(child);
+  return entries.types[child];
 }
 
-std::string PathController::pathType(std::filesystem::path const &path) {
-  namespace fs = std::filesystem;
-  if (fs::is_directory(path)) {
-    return "directory";
-  } else if (fs::is_regular_file(path)) {
-    return "file";
-  } else {
-    return "unknown";
+void PathController::showHidden(bool const showHiddenFiles) {
+  _showHiddenFiles = showHiddenFiles;
+}
+
+/// show only the children that are directories, or lead to one.
+void PathController::showDirectoriesOnly(bool const directoriesOnly) {
+  _directoriesOnly = directoriesOnly;
+}
+
+/// show only the children whose names end in extension, e.g. ".cpp", or
+/// every child if it is empty.
+void PathController::showExtension(std::string const &extension) {
+  _extension = extension;
+}
+
+/// the order children are loaded in.
+void PathController::sortBy(SortOrder const order) { _order = order; }
+
+/// choose the children to show again, in order, once the order or a filter
+/// has changed. the directory is not read again, and the listing keeps each
+/// order it has sorted, so this is one pass over the children loaded.
+void PathController::rearrange() {
+  if (_listing)
+    _arrange();
+}
+
+/// load the children of path, from the cache if there is one, in the order
+/// set by sortBy(). throws std::filesystem::filesystem_error if the
+/// directory cannot be read.
+void PathController::loadParent(std::filesystem::path const &path) {
+  _stopReading();
+  _listing = _cache != nullptr ? _cache->load(path)
+                               : DirectoryListing::read(path);
+  _arrange();
+}
+
+/// start loading the children of path without waiting for them. a cached
+/// listing is there at once; otherwise the directory is read on another
+/// thread, and poll() shows what has arrived. throws
+/// std::filesystem::filesystem_error if the directory cannot be opened.
+void PathController::loadProgressively(std::filesystem::path const &path) {
+  _stopReading();
+  _listing = _cache != nullptr ? _cache->cached(path) : nullptr;
+  if (_listing) {
+    _arrange();
+    return;
+  }
+  if (_cache != nullptr)
+    _cache->watch(path); // before reading, so no change is missed
+  try {
+    _listing = DirectoryListing::open(path);
+  } catch (...) {
+    if (_cache != nullptr)
+      _cache->unwatch(path);
+    throw;
   }
+  _reader = std::make_unique<DirectoryReader>(_listing->dirFd);
+  _arrange();
 }
 
-std::filesystem::path PathController::parentPathObj() const {
-  return _parentPath;
+/// take the children read since the last poll, waiting up to timeoutMs for
+/// some. they are added to the end of the children shown, and the whole is
+/// sorted again each time it has doubled, and once every child has been
+/// read. returns true if the children shown have changed.
+bool PathController::poll(int const timeoutMs) {
+  if (!_reader)
+    return false;
+  auto &entries = _listing->entries;
+  size_t const first = entries.size();
+  bool const finished = _reader->take(entries, timeoutMs);
+  if (finished) {
+    bool const complete = _reader->error() == 0;
+    _reader.reset();
+    if (_cache != nullptr && complete)
+      _cache->store(_listing->path, _listing);
+    else if (_cache != nullptr)
+      _cache->unwatch(_listing->path);
+  }
+  if (entries.size() == first && !finished)
+    return false;
+
+  if (finished || entries.size() >= 2 * _sortedCount) {
+    _arrange();
+    return true;
+  }
+  for (size_t i = first; i < entries.size(); ++i) {
+    if (!_shows(i))
+      continue;
+    _shown.push_back(i);
+    _max = std::max(_max, entries.name(i).length());
+  }
+  return true;
 }
 
-size_t PathController::childrenSize() const { return _children.size(); }
+/// true until every child has been read.
+bool PathController::loading() const { return _reader != nullptr; }
 
-std::vector<std::filesystem::path> PathController::children() const {
-  return _children;
+/// the children read so far, hidden ones included.
+size_t PathController::loaded() const {
+  return _listing ? _listing->entries.size() : 0;
 }
 
-void PathController::showHidden(bool const showHiddenFiles) {
-  _showHiddenFiles = showHiddenFiles;
+/// an id for a child that stays the same while it is loading and sorting.
+uint32_t PathController::id(size_t const idx) const { return _shown[idx]; }
+
+/// where the child with the given id is now, or childrenSize() if nowhere.
+size_t PathController::find(uint32_t const id) const {
+  return std::find(_shown.begin(), _shown.end(), id) - _shown.begin();
 }
 
-void PathController::loadParent(std::filesystem::path const &path) {
-  _parentPath = path;
-  // use list for case insensitive sort
-  std::list<std::filesystem::path> childrenList;
-
-  for (const auto &entry : std::filesystem::directory_iterator(_parentPath)) {
-    std::string entryString = entry.path().filename(); // name of child.
-    if (_showHiddenFiles) {
-      childrenList.push_back(entry.path());
-    } else if (!_showHiddenFiles) {
-      if (entryString[0] != '.')
-        childrenList.push_back(entry.path());
-    }
+/// sort the children loaded and choose those to show.
+void PathController::_arrange() {
+  auto &entries = _listing->entries;
+  _shown.clear();
+  _max = 0;
+  _sortedCount = entries.size();
+
+  // what the order needs of the metadata, hidden entries included, as the
+  // order is kept for every controller sharing the listing.
+  if (sortNeedsMetadata(_order)) {
+    _shown.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+      _shown[i] = i;
+    statAll();
+    _shown.clear();
+  } else if (_order == SortOrder::TYPE) {
+    for (size_t i = 0; i < entries.size(); ++i)
+      if (entries.types[i] == PathType::UNKNOWN && !entries.statted(i))
+        _listing->stat(i);
   }
 
-  auto _nocase = [](const std::string &first, const std::string &second) {
-    unsigned int i = 0;
-    while ((i < first.length()) && (i < second.length())) {
-      if (tolower(first[i]) < tolower(second[i]))
-        return true;
-      else if (tolower(first[i]) > tolower(second[i]))
-        return false;
-      ++i;
-    }
-    return (first.length() < second.length());
-  };
-
-  childrenList.sort(_nocase);
-  _children = {std::make_move_iterator(std::begin(childrenList)),
-               std::make_move_iterator(std::end(childrenList))};
-
-  // get max length of loaded children.
-  for (std::string const &entry : _children) {
-    std::string entryName = stripSubstring(entry, _parentPath.string() + "/");
-    size_t nameLen = entryName.length();
-    if (nameLen > _max) {
-      _max = nameLen;
+  std::vector<uint32_t> const &order = _listing->order(_order);
+  _shown.reserve(order.size());
+  for (uint32_t const idx : order) {
+    if (!_shows(idx))
+      continue;
+    _shown.push_back(idx);
+    // get max length of loaded children.
+    _max = std::max(_max, entries.name(idx).length());
+  }
+}
+
+/// true if the filters let a child of the listing through. only a link,
+/// or a child on a filesystem that does not report types, can need a statx
+/// to be shown as a directory, and only once.
+bool PathController::_shows(uint32_t const child) {
+  PathEntries const &entries = _listing->entries;
+  if (!_showHiddenFiles && entries.hidden(child))
+    return false;
+  if (_directoriesOnly) {
+    if (entries.types[child] == PathType::UNKNOWN && !entries.statted(child))
+      _listing->stat(child);
+    if (entries.types[child] != PathType::DIRECTORY)
+      return false;
+  }
+  if (!_extension.empty()) {
+    std::string_view const name = entries.name(child);
+    if (name.size() <= _extension.size() ||
+        name.compare(name.size() - _extension.size(), _extension.size(),
+                     _extension) != 0)
+      return false;
+  }
+  return true;
+}
+
+/// stop a progressive load, leaving what was read.
+void PathController::_stopReading() {
+  if (!_reader)
+    return;
+  _reader.reset();
+  if (_cache != nullptr)
+    _cache->unwatch(_listing->path);
+}
+
+/// fill in the metadata of every child not yet statted. the first few are
+/// done one at a time, and timed: when the metadata is cached a statx takes
+/// a microsecond or two and a batch only adds overhead, so the rest follow
+/// the same way. slower answers mean a cold cache or a network filesystem,
+/// and the rest are handed to the fetcher to wait on together.
+void PathController::statAll() {
+  std::vector<size_t> pending;
+  for (uint32_t const idx : _shown)
+    if (!_listing->entries.statted(idx))
+      pending.push_back(idx);
+
+  size_t const probe = std::min(pending.size(), _BATCH_THRESHOLD);
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < probe; ++i)
+    _listing->stat(pending[i]);
+  auto const spent = std::chrono::steady_clock::now() - start;
+  if (probe == pending.size())
+    return;
+
+  pending.erase(pending.begin(), pending.begin() + probe);
+  if (spent < probe * _CACHED_STAT) {
+    for (size_t const idx : pending)
+      _listing->stat(idx);
+    return;
+  }
+  if (!_fetcher)
+    _fetcher = std::make_unique<MetadataFetcher>();
+  _fetcher->fetch(_listing->dirFd, _listing->entries, pending);
+}
+
+/// open path for reading. the listing keeps it absolute, as it may be
+/// cached and used after the working directory has changed. throws
+/// std::filesystem::filesystem_error if it cannot be opened.
+std::shared_ptr<DirectoryListing>
+DirectoryListing::open(std::filesystem::path const &path) {
+  auto listing = std::make_shared<DirectoryListing>();
+  listing->path = std::filesystem::absolute(path).lexically_normal();
+  listing->dirFd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (listing->dirFd < 0)
+    throw std::filesystem::filesystem_error(
+        "cannot open directory", path,
+        std::error_code(errno, std::generic_category()));
+  return listing;
+}
+
+/// read every child of path. throws std::filesystem::filesystem_error if the
+/// directory cannot be read.
+std::shared_ptr<DirectoryListing>
+DirectoryListing::read(std::filesystem::path const &path) {
+  auto listing = open(path);
+  int result;
+  while ((result = readSome(listing->dirFd, listing->entries)) > 0)
+    ;
+  if (result < 0)
+    throw std::filesystem::filesystem_error(
+        "cannot read directory", path,
+        std::error_code(-result, std::generic_category()));
+  return listing;
+}
+
+/// the indices of the entries in the given order, sorted the first time it
+/// is asked for. orders by metadata expect the entries to have been
+/// statted.
+std::vector<uint32_t> const &DirectoryListing::order(SortOrder const sortOrder) {
+  auto &sorted = _orders[static_cast<size_t>(sortOrder)];
+  if (sorted.size() != entries.size())
+    sorted = sortListing(entries, sortOrder);
+  return sorted;
+}
+
+/// read the next batch of the directory with one getdents64, taking the
+/// type from each record where the filesystem gives one. returns 1 if there
+/// may be more, 0 at the end, or -errno.
+int DirectoryListing::readSome(int const dirFd, PathEntries &out) {
+  alignas(linux_dirent64) char buffer[64 * 1024];
+  long n;
+  while ((n = syscall(SYS_getdents64, dirFd, buffer, sizeof(buffer))) < 0 &&
+         errno == EINTR)
+    ;
+  if (n <= 0)
+    return n < 0 ? -errno : 0;
+
+  for (long at = 0; at < n;) {
+    auto const *record = reinterpret_cast<linux_dirent64 *>(buffer + at);
+    at += record->d_reclen;
+
+    char const *const name = record->d_name;
+    if (name[0] == '.' &&
+        (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+      continue;
+
+    PathType type;
+    switch (record->d_type) {
+    case DT_DIR:
+      type = PathType::DIRECTORY;
+      break;
+    case DT_REG:
+      type = PathType::FILE;
+      break;
+    case DT_LNK:
+    case DT_UNKNOWN:
+      type = PathType::UNKNOWN; // known once the entry is statted
+      break;
+    default:
+      type = PathType::OTHER;
     }
+    out.push(name, type);
+  }
+  return 1;
+}
+
+/// fill in the metadata of entry idx with one statx, following links as
+/// the listing always has. an entry that cannot be statted keeps its type
+/// and has no permissions.
+void DirectoryListing::stat(size_t const idx) {
+  entries.makeMetadata();
+  struct statx st;
+  unsigned const mask = STATX_TYPE | STATX_MODE | STATX_MTIME | STATX_SIZE;
+  bool const ok = statx(dirFd, entries.cName(idx), AT_STATX_SYNC_AS_STAT,
+                        mask, &st) == 0;
+  MetadataFetcher::apply(entries, idx, ok ? &st : nullptr);
+}
+
+/// add a child read from the directory.
+void PathEntries::push(std::string_view const name, PathType const type) {
+  offsets.push_back(names.size());
+  names.insert(names.end(), name.begin(), name.end());
+  names.push_back('\0');
+  types.push_back(type);
+  flags.push_back(!name.empty() && name[0] == '.' ? HIDDEN : 0);
+  if (!modes.empty()) {
+    modes.push_back(0);
+    mtimes.push_back(0);
+    sizes.push_back(0);
+  }
+}
+
+/// add the children of other after these.
+void PathEntries::append(PathEntries const &other) {
+  bool const metadata = !modes.empty() || !other.modes.empty();
+  if (metadata)
+    makeMetadata();
+  uint32_t const base = names.size();
+  names.insert(names.end(), other.names.begin(), other.names.end());
+  offsets.reserve(offsets.size() + other.offsets.size());
+  for (uint32_t const offset : other.offsets)
+    offsets.push_back(base + offset);
+  types.insert(types.end(), other.types.begin(), other.types.end());
+  flags.insert(flags.end(), other.flags.begin(), other.flags.end());
+  if (!metadata)
+    return;
+  if (other.hasMetadata()) {
+    modes.insert(modes.end(), other.modes.begin(), other.modes.end());
+    mtimes.insert(mtimes.end(), other.mtimes.begin(), other.mtimes.end());
+    sizes.insert(sizes.end(), other.sizes.begin(), other.sizes.end());
+  } else {
+    makeMetadata();
   }
 }
 
+/// make the metadata columns as long as the rest, before statting.
+void PathEntries::makeMetadata() {
+  if (hasMetadata())
+    return;
+  modes.resize(size());
+  mtimes.resize(size());
+  sizes.resize(size());
+}
+
+void PathEntries::clear() {
+  names.clear();
+  offsets.clear();
+  types.clear();
+  flags.clear();
+  modes.clear();
+  mtimes.clear();
+  sizes.clear();
+}
+
+DirectoryListing::~DirectoryListing() {
+  if (dirFd >= 0)
+    ::close(dirFd);
+}
+
 std::vector<std::string> PathController::generateFields() {
   // generate fields
   std::vector<std::string> fields;
-  for (std::string const &entry : _children) {
-    std::string entityPad = std::to_string(_max + 3);
-    std::string formatString = "{0:<" + entityPad + "}{1:<12}{2:<12}{3:<21}";
-    std::string fieldName = fmt::format(
-        formatString, stripSubstring(entry, _parentPath.string() + "/"),
-        pathType(entry), pathPermissions(entry), pathLastModifiedDate(entry));
-    fields.push_back(fieldName);
-  }
+  fields.reserve(_shown.size());
+  statAll();
+  for (size_t i = 0; i < _shown.size(); ++i)
+    fields.push_back(field(i));
   return fields;
 }
 
+/// the line shown for a child, statting it if it has not been.
+std::string PathController::field(size_t const idx) {
+  uint32_t const child = _shown[idx];
+  PathEntries const &entries = _listing->entries;
+  if (!entries.statted(child))
+    _listing->stat(child);
+  char date[DateFormatter::MAX_LENGTH];
+  std::string_view modified = "unknown";
+  if (!entries.missing(child))
+    modified = {date, _dates.format(entries.mtimes[child], date)};
+
+  // laid out as generateTitle() lays out the headings.
+  std::string line;
+  line.reserve(_max + 3 + 12 + 12 + 21);
+  appendColumn(line, entries.name(child), _max + 3);
+  appendColumn(line, typeName(entries.types[child]), 12);
+  appendColumn(line, permissionString(entries.modes[child]), 12);
+  appendColumn(line, modified, 21);
+  return line;
+}
+
 std::string PathController::generateTitle() const {
   std::string entityPad = std::to_string(_max + 3);
   std::string formatString = "{0:<" + entityPad + "}{1:<12}{2:<12}{3:<21}";
@@ -22,34 +22,148 @@
  * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
  */
 
+#include "ListingFormat.h"
+#include "ListingSort.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace BlackOS {
 namespace Trinkets {
+
+/// what a path is, following symbolic links.
+enum class PathType : uint8_t { UNKNOWN, DIRECTORY, FILE, OTHER };
+
+/// the children of a directory, kept column by column. the names lie end
+/// to end in one block, each ended by a NUL so statx can take it as it is,
+/// and what is known of each child is in arrays alongside. the name and,
+/// when the filesystem reports it, the type come from reading the
+/// directory; the metadata columns are only made once a child is statted,
+/// as most listings show no more than a page of it. whether a child is
+/// hidden is noted in its flags as it is read, so filters need not look at
+/// the names.
+struct PathEntries {
+  enum Flag : uint8_t {
+    STATTED = 1, // statx has been tried
+    MISSING = 2, // it failed, e.g. for a broken link
+    HIDDEN = 4   // the name starts with a dot
+  };
+
+  std::vector<char> names;       // every name, each followed by a NUL
+  std::vector<uint32_t> offsets; // where each name starts in names
+  std::vector<PathType> types;
+  std::vector<uint8_t> flags;  // of Flag
+  std::vector<uint16_t> modes; // permission bits
+  std::vector<int64_t> mtimes;
+  std::vector<uint64_t> sizes;
+
+  size_t size() const { return offsets.size(); }
+  std::string_view name(size_t const idx) const {
+    size_t const end =
+        idx + 1 < offsets.size() ? offsets[idx + 1] : names.size();
+    return {names.data() + offsets[idx], end - offsets[idx] - 1};
+  }
+  char const *cName(size_t const idx) const {
+    return names.data() + offsets[idx];
+  }
+  bool hidden(size_t const idx) const { return flags[idx] & HIDDEN; }
+  bool statted(size_t const idx) const { return flags[idx] & STATTED; }
+  bool missing(size_t const idx) const { return flags[idx] & MISSING; }
+  bool hasMetadata() const { return modes.size() == size(); }
+
+  void push(std::string_view const name, PathType const type);
+  void append(PathEntries const &other);
+  void makeMetadata();
+  void clear();
+};
+
+/// every child of a directory, hidden ones included, in the order read. a
+/// listing may be shared through a DirectoryCache, so the metadata statted
+/// and the orders sorted for one controller are there for the next.
+struct DirectoryListing {
+  std::filesystem::path path;
+  PathEntries entries;
+  int dirFd = -1; // the directory, for statx relative to it
+
+  static std::shared_ptr<DirectoryListing>
+  open(std::filesystem::path const &path);
+  static std::shared_ptr<DirectoryListing>
+  read(std::filesystem::path const &path);
+  static int readSome(int const dirFd, PathEntries &out);
+  void stat(size_t const idx);
+  std::vector<uint32_t> const &order(SortOrder const sortOrder);
+
+  DirectoryListing() = default;
+  DirectoryListing(DirectoryListing const &) = delete;
+  DirectoryListing &operator=(DirectoryListing const &) = delete;
+  ~DirectoryListing();
+
+private:
+  std::array<std::vector<uint32_t>, SORT_ORDERS> _orders; // sorted on demand
+};
+
+class DirectoryCache;
+class DirectoryReader;
+class MetadataFetcher;
+
 struct PathController {
 public:
+  explicit PathController(DirectoryCache *cache = nullptr);
+  PathController(PathController const &) = delete;
+  PathController &operator=(PathController const &) = delete;
+  ~PathController();
+
   size_t childrenSize() const;
-  std::vector<std::filesystem::path> children() const;
+  std::filesystem::path childPath(size_t const idx) const;
+  std::string_view name(size_t const idx) const;
+  PathType type(size_t const idx);
+  void statAll();
   std::vector<std::string> generateFields();
+  std::string field(size_t const idx);
   std::string generateTitle() const;
   std::filesystem::path parentPathObj() const;
-  void loadChildren();
   void loadParent(std::filesystem::path const &path);
+  void loadProgressively(std::filesystem::path const &path);
+  bool poll(int const timeoutMs = 0);
+  bool loading() const;
+  size_t loaded() const;
+  uint32_t id(size_t const idx) const;
+  size_t find(uint32_t const id) const;
   void showHidden(bool const showHiddenFiles = 0);
+  void showDirectoriesOnly(bool const directoriesOnly);
+  void showExtension(std::string const &extension);
+  void sortBy(SortOrder const order);
+  void rearrange();
 
-  std::string stripSubstring(std::string str, std::string const &substring);
   std::string timestampToDateTime(time_t const rawtime);
-  std::string pathLastModifiedDate(std::string const &path);
-  std::string pathPermissions(std::string const &path);
-  std::string pathType(std::filesystem::path const &path);
+  static char const *typeName(PathType const type);
 
 private:
-  std::vector<std::filesystem::path> _children;
-  std::filesystem::path _parentPath;
-  bool _showHiddenFiles;
+  void _arrange();
+  bool _shows(uint32_t const child);
+  void _stopReading();
+
+  static constexpr size_t _BATCH_THRESHOLD = 32; // children statted to probe
+  static constexpr std::chrono::microseconds _CACHED_STAT{10};
+
+  std::shared_ptr<DirectoryListing> _listing;
+  std::vector<uint32_t> _shown; // indices into the listing, in order
+  DirectoryCache *_cache;       // listings are read afresh without one
+  bool _showHiddenFiles = false;
+  bool _directoriesOnly = false;
+  std::string _extension; // of the only children shown, if not empty
+  SortOrder _order = SortOrder::NAME;
   size_t _max = 0;
+  size_t _sortedCount = 0; // entries when the shown order was last sorted
+  std::unique_ptr<DirectoryReader> _reader;  // while loading progressively
+  std::unique_ptr<MetadataFetcher> _fetcher; // made on the first batch
+  DateFormatter _dates;
 };
 } // namespace Trinkets
 } // namespace BlackOS
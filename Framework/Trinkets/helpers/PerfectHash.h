@@ -0,0 +1,113 @@
+#ifndef TRINKETS_PERFECT_HASH_H
+#define TRINKETS_PERFECT_HASH_H
+
+/**
+ * PerfectHash
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// FNV-1a over name, started from seed. the low bits of FNV depend only on
+/// the low bits of its input, so the result is mixed before it is masked.
+constexpr uint32_t hashName(std::string_view const name, uint32_t const seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (char const c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+/// a fixed set of entries, each with a name, arranged when it is made so
+/// that no two names hash to the same slot. made constexpr, the search for
+/// a seed that spreads the names runs at compile time; a lookup is then one
+/// hash, one slot read and one comparison, and allocates nothing.
+template <typename Entry, size_t N> class PerfectHash {
+public:
+  static_assert(N > 0 && N < 255, "PerfectHash holds 1 to 254 entries");
+
+  constexpr explicit PerfectHash(Entry const (&entries)[N])
+      : PerfectHash(entries, std::make_index_sequence<N>()) {}
+
+  /// the entry called name, or nullptr.
+  constexpr Entry const *find(std::string_view const name) const {
+    uint8_t const idx = _slots[hashName(name, _seed) & (SLOTS - 1)];
+    if (idx == EMPTY || _entries[idx].name != name)
+      return nullptr;
+    return &_entries[idx];
+  }
+
+  constexpr std::array<Entry, N> const &entries() const { return _entries; }
+
+private:
+  template <size_t... I>
+  constexpr PerfectHash(Entry const (&entries)[N], std::index_sequence<I...>)
+      : _entries{{entries[I]...}}, _seed(0), _slots() {
+    for (size_t i = 0; i < N; ++i)
+      for (size_t j = 0; j < i; ++j)
+        if (entries[j].name == entries[i].name)
+          throw std::logic_error("PerfectHash: duplicate name");
+    while (!_place()) {
+      if (++_seed == 1u << 20)
+        throw std::logic_error("PerfectHash: no seed found");
+    }
+  }
+
+  static constexpr size_t _slotCount() {
+    size_t slots = 1;
+    while (slots < 2 * N)
+      slots *= 2;
+    return slots;
+  }
+
+  static constexpr size_t SLOTS = _slotCount();
+  static constexpr uint8_t EMPTY = 255;
+
+  /// spread the entries with the current seed. returns false on a collision.
+  constexpr bool _place() {
+    for (auto &slot : _slots)
+      slot = EMPTY;
+    for (size_t i = 0; i < N; ++i) {
+      uint8_t &slot = _slots[hashName(_entries[i].name, _seed) & (SLOTS - 1)];
+      if (slot != EMPTY)
+        return false;
+      slot = static_cast<uint8_t>(i);
+    }
+    return true;
+  }
+
+  std::array<Entry, N> _entries;
+  uint32_t _seed;
+  std::array<uint8_t, SLOTS> _slots;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
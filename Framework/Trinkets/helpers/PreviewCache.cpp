@@ -0,0 +1,59 @@
+/**
+ * PreviewCache
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "PreviewCache.h"
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// the preview of dir made from listing with the same settings, or nullptr.
+ListViewPreview const *
+PreviewCache::find(std::filesystem::path const &dir,
+                   std::shared_ptr<DirectoryListing> const &listing,
+                   bool const hidden, SortOrder const order,
+                   size_t const height) const {
+  if (!listing)
+    return nullptr;
+  auto const it = _previews.find(dir.string());
+  if (it == _previews.end())
+    return nullptr;
+  ListViewPreview const &preview = it->second;
+  if (preview.listing.lock() != listing || preview.hidden != hidden ||
+      preview.order != order || preview.height != height)
+    return nullptr;
+  return &preview;
+}
+
+/// keep the preview of dir, in place of any before it, and forget those
+/// whose listings have gone.
+ListViewPreview const &PreviewCache::store(std::filesystem::path const &dir,
+                                           ListViewPreview preview) {
+  for (auto it = _previews.begin(); it != _previews.end();) {
+    if (it->second.listing.expired())
+      it = _previews.erase(it);
+    else
+      ++it;
+  }
+  return _previews[dir.string()] = std::move(preview);
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,67 @@
+#ifndef TRINKETS_PREVIEW_CACHE_H
+#define TRINKETS_PREVIEW_CACHE_H
+
+/**
+ * PreviewCache
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "ListingSort.h"
+#include "PathController.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// what the list view shows of a directory: the first children in order,
+/// with their types, and how many there are in all.
+struct ListViewPreview {
+  std::vector<std::pair<std::string, PathType>> lines;
+  size_t total = 0;
+  bool hidden = false; // hidden children included
+  SortOrder order = SortOrder::NAME;
+  size_t height = 0;                       // lines asked for
+  std::weak_ptr<DirectoryListing> listing; // made from
+};
+
+/// keeps the list view previews of directories, so moving the highlight
+/// back over one does not sort its listing again. a preview is only good
+/// while the directory cache still holds the listing it was made from, and
+/// is forgotten once that listing has gone.
+class PreviewCache {
+public:
+  ListViewPreview const *
+  find(std::filesystem::path const &dir,
+       std::shared_ptr<DirectoryListing> const &listing, bool const hidden,
+       SortOrder const order, size_t const height) const;
+  ListViewPreview const &store(std::filesystem::path const &dir,
+                               ListViewPreview preview);
+
+private:
+  std::unordered_map<std::string, ListViewPreview> _previews; // by path
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
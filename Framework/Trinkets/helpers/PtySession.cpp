@@ -0,0 +1,241 @@
+/**
+ * PtySession
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "PtySession.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+namespace {
+// the signal a key sends when terminal signals are on, or 0.
+int signalOf(struct termios const &attrs, char const key) {
+  cc_t const c = static_cast<cc_t>(key);
+  if (c == _POSIX_VDISABLE)
+    return 0;
+  if (c == attrs.c_cc[VINTR])
+    return SIGINT;
+  if (c == attrs.c_cc[VQUIT])
+    return SIGQUIT;
+  return 0;
+}
+} // namespace
+
+int PtySession::fd() const { return _master; }
+
+pid_t PtySession::pid() const { return _pid; }
+
+/// leave reaping the child to the caller, e.g. a Job. the child leads its
+/// own session, so its process group id is its pid.
+void PtySession::release() { _pid = -1; }
+
+/// the character that suspends the program (usually ^Z), or -1 if the
+/// program has turned terminal signals off.
+int PtySession::suspendChar() const {
+  struct termios attrs;
+  if (_master < 0 || tcgetattr(_master, &attrs) != 0)
+    return -1;
+  if (!(attrs.c_lflag & ISIG) || attrs.c_cc[VSUSP] == _POSIX_VDISABLE)
+    return -1;
+  return attrs.c_cc[VSUSP];
+}
+
+int PtySession::spawn(std::vector<std::string> const &argv, size_t const rows,
+                      size_t const cols) {
+  // build argv before forking so the child does not allocate.
+  std::vector<char *> args;
+  for (auto const &arg : argv)
+    args.push_back(const_cast<char *>(arg.c_str()));
+  args.push_back(nullptr);
+  return spawn(args.data(), rows, cols);
+}
+
+/// open a pseudo-terminal of rows x cols and fork argv, a null-terminated
+/// array, onto it as the controlling terminal of a new session. returns 0 on
+/// success, or -1 if the pseudo-terminal or the fork could not be made.
+int PtySession::spawn(char *const *argv, size_t const rows,
+                      size_t const cols) {
+  if (argv == nullptr || argv[0] == nullptr)
+    return -1;
+
+  _master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (_master < 0)
+    return -1;
+  char const *slaveName = nullptr;
+  if (grantpt(_master) != 0 || unlockpt(_master) != 0 ||
+      (slaveName = ptsname(_master)) == nullptr) {
+    _close();
+    return -1;
+  }
+  // ptsname uses a static buffer; keep a copy for the child.
+  std::string const slave = slaveName;
+
+  struct winsize size = {};
+  size.ws_row = rows;
+  size.ws_col = cols;
+  ioctl(_master, TIOCSWINSZ, &size);
+
+  _pid = fork();
+  if (_pid < 0) {
+    _close();
+    return -1;
+  }
+
+  if (_pid == 0) {
+    // child process
+    setsid();
+    int const slaveFd = open(slave.c_str(), O_RDWR);
+    if (slaveFd < 0)
+      _exit(127);
+    ioctl(slaveFd, TIOCSCTTY, 0);
+    dup2(slaveFd, STDIN_FILENO);
+    dup2(slaveFd, STDOUT_FILENO);
+    dup2(slaveFd, STDERR_FILENO);
+    if (slaveFd > STDERR_FILENO)
+      ::close(slaveFd);
+    for (int sig : {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGCHLD})
+      signal(sig, SIG_DFL);
+    // the embedded terminal understands the xterm subset programs rely on.
+    setenv("TERM", "xterm", 1);
+    execvp(argv[0], argv);
+    perror(argv[0]);
+    _exit(127);
+  }
+
+  fcntl(_master, F_SETFL, fcntl(_master, F_GETFL) | O_NONBLOCK);
+  return 0;
+}
+
+/// read what the child wrote to its terminal. returns the byte count, or -1
+/// with errno set; EAGAIN means nothing is waiting and EIO that the child
+/// side of the terminal has been closed.
+ssize_t PtySession::read(char *buffer, size_t const len) {
+  if (_master < 0) {
+    errno = EIO;
+    return -1;
+  }
+  return ::read(_master, buffer, len);
+}
+
+/// pass data to the child as if it had been typed. what its terminal cannot
+/// take yet is kept, in order, for flush(); the caller should flush once
+/// fd() is writable. returns false if the terminal has failed, or if the
+/// child has left so much unread that some of data was dropped.
+bool PtySession::write(char const *data, size_t const len) {
+  if (_master < 0)
+    return false;
+  struct termios attrs;
+  bool const signals =
+      tcgetattr(_master, &attrs) == 0 && (attrs.c_lflag & ISIG);
+  bool kept = true;
+  size_t start = 0;
+  for (size_t i = 0; signals && i < len; ++i) {
+    int const sig = signalOf(attrs, data[i]);
+    if (sig == 0)
+      continue;
+    kept = _keep(data + start, i - start) && kept;
+    start = i + 1;
+    if (!flush())
+      return false;
+    if (_unsent.empty() && ::write(_master, data + i, 1) == 1)
+      continue;
+    // a full terminal would hold the key behind input the program is not
+    // reading, so the signal is sent as the terminal would send it.
+    if (!(attrs.c_lflag & NOFLSH))
+      _unsent.clear();
+    pid_t const group = tcgetpgrp(_master);
+    if (group > 0)
+      kill(-group, sig);
+  }
+  kept = _keep(data + start, len - start) && kept;
+  return flush() && kept;
+}
+
+/// send what write() has kept, as much as the terminal takes without
+/// blocking. returns false, dropping the rest, if the terminal has failed.
+bool PtySession::flush() {
+  size_t sent = 0;
+  bool failed = _master < 0;
+  while (!failed && sent < _unsent.size()) {
+    ssize_t const put =
+        ::write(_master, _unsent.data() + sent, _unsent.size() - sent);
+    if (put < 0 && errno == EAGAIN)
+      break; // the child is not reading its input yet
+    if (put < 0)
+      failed = errno != EINTR;
+    else
+      sent += put;
+  }
+  if (failed)
+    _unsent.clear();
+  else
+    _unsent.erase(0, sent);
+  return !failed;
+}
+
+/// true while written data waits for the child to read it.
+bool PtySession::hasUnsent() const { return !_unsent.empty(); }
+
+/// add data to what is waiting to be sent. returns false if there was not
+/// room for all of it.
+bool PtySession::_keep(char const *data, size_t const len) {
+  size_t const room = _MAX_UNSENT - std::min(_MAX_UNSENT, _unsent.size());
+  _unsent.append(data, std::min(len, room));
+  return len <= room;
+}
+
+/// close the terminal and reap the child. returns its exit status, or -1 if
+/// it did not exit normally.
+int PtySession::wait() {
+  _close();
+  if (_pid <= 0)
+    return -1;
+  int status = 0;
+  while (waitpid(_pid, &status, 0) < 0 && errno == EINTR)
+    ;
+  _pid = -1;
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+void PtySession::_close() {
+  if (_master >= 0)
+    ::close(_master);
+  _master = -1;
+}
+
+PtySession::~PtySession() {
+  if (_pid > 0)
+    wait();
+  _close();
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
@@ -0,0 +1,64 @@
+#ifndef TRINKETS_PTY_SESSION_H
+#define TRINKETS_PTY_SESSION_H
+
+/**
+ * PtySession
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// runs a child process on a new pseudo-terminal. the child sees an ordinary
+/// terminal of the given size, and everything it writes can be read from fd()
+/// while keys typed for it are written back.
+class PtySession {
+public:
+  int spawn(std::vector<std::string> const &argv, size_t const rows,
+            size_t const cols);
+  int spawn(char *const *argv, size_t const rows, size_t const cols);
+  ssize_t read(char *buffer, size_t const len);
+  bool write(char const *data, size_t const len);
+  bool flush();
+  bool hasUnsent() const;
+  int wait();
+  int fd() const;
+  pid_t pid() const;
+  void release();
+  int suspendChar() const;
+
+  ~PtySession();
+
+private:
+  void _close();
+  bool _keep(char const *data, size_t const len);
+
+  int _master = -1;
+  pid_t _pid = -1;
+  std::string _unsent; // written, but not yet taken by the terminal
+
+  static constexpr size_t _MAX_UNSENT = 1 << 20;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
@@ -0,0 +1,56 @@
+/**
+ * StartupProfiler
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include "StartupProfiler.h"
+
+#include <fmt/format.h>
+
+namespace BlackOS {
+namespace Trinkets {
+
+StartupProfiler::StartupProfiler() : _start(clock::now()) {
+  _phases.reserve(16);
+}
+
+/// end the phase named, which began at the previous mark.
+void StartupProfiler::mark(char const *phase) {
+  _phases.push_back({phase, clock::now()});
+}
+
+/// one line per phase: its name, how long it took and when it ended.
+std::vector<std::string> StartupProfiler::report() const {
+  std::vector<std::string> lines;
+  lines.push_back(fmt::format("{:<24}{:>10}{:>10}", "phase", "ms", "at"));
+  clock::time_point begin = _start;
+  for (auto const &phase : _phases) {
+    double const took =
+        std::chrono::duration<double, std::milli>(phase.end - begin).count();
+    double const at =
+        std::chrono::duration<double, std::milli>(phase.end - _start).count();
+    lines.push_back(
+        fmt::format("{:<24}{:>10.2f}{:>10.2f}", phase.name, took, at));
+    begin = phase.end;
+  }
+  return lines;
+}
+
+} // namespace Trinkets
+} // namespace BlackOS
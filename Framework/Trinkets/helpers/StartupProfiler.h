@@ -0,0 +1,55 @@
+#ifndef TRINKETS_STARTUP_PROFILER_H
+#define TRINKETS_STARTUP_PROFILER_H
+
+/**
+ * StartupProfiler
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace BlackOS {
+namespace Trinkets {
+
+/// a timeline of the phases of startup. each mark ends the phase named and
+/// starts the next; timing starts when the profiler is made. marks are cheap
+/// enough to be left in whether or not the timeline is shown.
+class StartupProfiler {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  StartupProfiler();
+
+  void mark(char const *phase);
+  std::vector<std::string> report() const;
+
+private:
+  struct Phase {
+    char const *name;
+    clock::time_point end;
+  };
+
+  clock::time_point _start;
+  std::vector<Phase> _phases;
+};
+} // namespace Trinkets
+} // namespace BlackOS
+#endif
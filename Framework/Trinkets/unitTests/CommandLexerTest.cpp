@@ -0,0 +1,311 @@
+/**
+ * CommandLexerTests
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+// Using catch2 headers
+
+#define CATCH_CONFIG_RUNNER
+
+#include "../helpers/CommandLexer.h"
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace BlackOS::Trinkets;
+
+namespace {
+/// the variables the tables below expand.
+void setVariables() {
+  setenv("HOME", "/home/me", 1);
+  setenv("NAME", "value", 1);
+  setenv("EMPTY", "", 1);
+  setenv("SPACED", "a b", 1);
+  unsetenv("UNSET");
+}
+
+/// tokens written out: a word in brackets, an operator as the descriptor it
+/// applies to followed by the operator, so "a 2>>b" is "[a] 2>> [b]".
+std::string render(std::vector<Token> const &tokens) {
+  std::string out;
+  for (auto const &token : tokens) {
+    if (!out.empty())
+      out += ' ';
+    switch (token.kind) {
+    case TokenKind::WORD:
+      out += '[' + std::string(token.text, token.len) + ']';
+      break;
+    case TokenKind::PIPE:
+      out += '|';
+      break;
+    case TokenKind::REDIRECT_IN:
+      out += std::to_string(token.fd) + '<';
+      break;
+    case TokenKind::REDIRECT_OUT:
+      out += std::to_string(token.fd) + '>';
+      break;
+    case TokenKind::REDIRECT_APPEND:
+      out += std::to_string(token.fd) + ">>";
+      break;
+    }
+  }
+  return out;
+}
+
+struct LexCase {
+  char const *line;
+  char const *tokens;
+};
+
+struct ErrorCase {
+  char const *line;
+  char const *error;
+};
+
+struct LastWordCase {
+  char const *line;
+  size_t start;
+  char const *text;
+  char quote;
+  bool first;
+};
+
+void checkLexes(std::vector<LexCase> const &cases) {
+  setVariables();
+  CommandLexer lexer;
+  for (auto const &c : cases) {
+    INFO("line: " << c.line);
+    REQUIRE(lexer.lex(c.line) == 0);
+    REQUIRE(lexer.error() == nullptr);
+    REQUIRE(render(lexer.tokens()) == c.tokens);
+  }
+}
+} // namespace
+
+TEST_CASE("words are split on blanks", "[lex]") {
+  checkLexes({
+      {"", ""},
+      {" \t ", ""},
+      {"ls", "[ls]"},
+      {"ls -la /tmp", "[ls] [-la] [/tmp]"},
+      {"  ls\t -la  ", "[ls] [-la]"},
+  });
+}
+
+TEST_CASE("quotes keep blanks and operators in a word", "[lex]") {
+  checkLexes({
+      {"echo 'a b'", "[echo] [a b]"},
+      {"echo 'a|b' \"c>d\" 'e<f'", "[echo] [a|b] [c>d] [e<f]"},
+      {"echo 'a\"b$NAME\\'", "[echo] [a\"b$NAME\\]"},
+      {"echo \"a $NAME\"", "[echo] [a value]"},
+      {"echo \"${NAME}s\"", "[echo] [values]"},
+      {"echo \"a'b\"", "[echo] [a'b]"},
+      {"echo \"\\$NAME \\\" \\\\ \\` \\n\"", "[echo] [$NAME \" \\ ` \\n]"},
+      {"echo ab'c d'\"e\"f", "[echo] [abc def]"},
+      {"echo '' \"\"", "[echo] [] []"},
+      {"echo \"$EMPTY\"", "[echo] []"},
+  });
+}
+
+TEST_CASE("a backslash escapes the next character", "[lex]") {
+  checkLexes({
+      {"echo a\\ b", "[echo] [a b]"},
+      {"echo \\'x \\\"y", "[echo] ['x] [\"y]"},
+      {"echo \\$NAME", "[echo] [$NAME]"},
+      {"echo a\\|b c\\>d", "[echo] [a|b] [c>d]"},
+      {"echo \\\\", "[echo] [\\]"},
+      {"echo \\~", "[echo] [~]"},
+      {"echo end\\", "[echo] [end\\]"},
+      {"echo \\ ", "[echo] [ ]"},
+  });
+}
+
+TEST_CASE("variables and ~ are expanded outside single quotes", "[lex]") {
+  checkLexes({
+      {"echo $NAME ${NAME}", "[echo] [value] [value]"},
+      {"echo $NAME$NAME x${NAME}y", "[echo] [valuevalue] [xvaluey]"},
+      {"echo $NAME.txt $NAMEx", "[echo] [value.txt]"},
+      {"echo $SPACED", "[echo] [a b]"},
+      {"echo $EMPTY $UNSET", "[echo]"},
+      {"echo ${EMPTY}", "[echo]"},
+      {"echo $ $1 a$ $-", "[echo] [$] [$1] [a$] [$-]"},
+      {"echo ~ ~/x ~user a~", "[echo] [/home/me] [/home/me/x] [~user] [a~]"},
+      {"echo '~' \"~\" '$NAME'", "[echo] [~] [~] [$NAME]"},
+      {"cd ~|cat", "[cd] [/home/me] | [cat]"},
+  });
+}
+
+TEST_CASE("operators are found between and inside words", "[lex]") {
+  checkLexes({
+      {"a|b", "[a] | [b]"},
+      {"a | b | c", "[a] | [b] | [c]"},
+      {"a < in > out", "[a] 0< [in] 1> [out]"},
+      {"a<in>out", "[a] 0< [in] 1> [out]"},
+      {"a >> log", "[a] 1>> [log]"},
+      {"a 2> err", "[a] 2> [err]"},
+      {"a 2>>err", "[a] 2>> [err]"},
+      {"a 12<in", "[a] 12< [in]"},
+      {"a 2 > x", "[a] [2] 1> [x]"},
+      {"a b2>x", "[a] [b2] 1> [x]"},
+      {"a >'my file'", "[a] 1> [my file]"},
+      {"< in sort", "0< [in] [sort]"},
+  });
+}
+
+TEST_CASE("malformed lines are refused with a reason", "[lex]") {
+  setVariables();
+  std::vector<ErrorCase> const cases = {
+      {"echo 'abc", "unterminated quote"},
+      {"echo \"abc", "unterminated quote"},
+      {"echo \"abc\\\"", "unterminated quote"},
+      {"echo 'a'b'", "unterminated quote"},
+      {"echo ${NAME", "missing '}'"},
+      {"echo \"${NAME\"", "missing '}'"},
+      {"| a", "empty command in pipeline"},
+      {"a |", "empty command in pipeline"},
+      {"a || b", "empty command in pipeline"},
+      {"a | 2>x | b", "empty command in pipeline"},
+      {"a >", "missing file name after redirection"},
+      {"a > | b", "missing file name after redirection"},
+      {"a < > b", "missing file name after redirection"},
+      {"a 2>", "missing file name after redirection"},
+  };
+  CommandLexer lexer;
+  for (auto const &c : cases) {
+    INFO("line: " << c.line);
+    REQUIRE(lexer.lex(c.line) == -1);
+    REQUIRE(lexer.error() != nullptr);
+    REQUIRE(std::string(lexer.error()) == c.error);
+    // a good line afterwards is not affected by the bad one.
+    REQUIRE(lexer.lex("ls -l") == 0);
+    REQUIRE(lexer.error() == nullptr);
+    REQUIRE(render(lexer.tokens()) == "[ls] [-l]");
+  }
+}
+
+TEST_CASE("argv holds the words of a line without operators", "[lex]") {
+  setVariables();
+  CommandLexer lexer;
+  REQUIRE(lexer.lex("echo 'a b' \"$NAME\" ''") == 0);
+  REQUIRE_FALSE(lexer.hasOperators());
+  REQUIRE(lexer.argc() == 4);
+  char *const *argv = lexer.argv();
+  REQUIRE(std::string(argv[0]) == "echo");
+  REQUIRE(std::string(argv[1]) == "a b");
+  REQUIRE(std::string(argv[2]) == "value");
+  REQUIRE(std::string(argv[3]).empty());
+  REQUIRE(argv[4] == nullptr);
+
+  REQUIRE(lexer.lex("echo 'a|b' c\\>d") == 0);
+  REQUIRE_FALSE(lexer.hasOperators());
+  REQUIRE(lexer.lex("ls | wc") == 0);
+  REQUIRE(lexer.hasOperators());
+  REQUIRE(lexer.lex("ls 2>/dev/null") == 0);
+  REQUIRE(lexer.hasOperators());
+
+  REQUIRE(lexer.lex("") == 0);
+  REQUIRE(lexer.argc() == 0);
+  REQUIRE(lexer.argv()[0] == nullptr);
+}
+
+TEST_CASE("words longer than an arena block stay whole", "[lex]") {
+  setVariables();
+  std::string line;
+  std::vector<std::string> words;
+  for (size_t i = 0; i < 64; ++i) {
+    words.push_back(std::string(i * 97 + 1, static_cast<char>('a' + i % 26)));
+    line += "'" + words.back() + "' ";
+  }
+  CommandLexer lexer;
+  for (int pass = 0; pass < 2; ++pass) {
+    REQUIRE(lexer.lex(line) == 0);
+    REQUIRE(lexer.argc() == words.size());
+    for (size_t i = 0; i < words.size(); ++i)
+      REQUIRE(lexer.argv()[i] == words[i]);
+  }
+}
+
+TEST_CASE("the last word is found as lex() would split it", "[lastWord]") {
+  std::vector<LastWordCase> const cases = {
+      {"", 0, "", 0, true},
+      {"ls", 0, "ls", 0, true},
+      {"  ls", 2, "ls", 0, true},
+      {"ls ", 3, "", 0, false},
+      {"ls -l /us", 6, "/us", 0, false},
+      {"cd My\\ Do", 3, "My Do", 0, false},
+      {"cd 'My Do", 3, "My Do", '\'', false},
+      {"cd 'My Docs'", 3, "My Docs", 0, false},
+      {"cd \"a\\\"b", 3, "a\"b", '"', false},
+      {"cd \"$HO", 3, "$HO", '"', false},
+      {"cd a'b c'\"d", 3, "ab cd", '"', false},
+      {"echo 'a|b", 5, "a|b", '\'', false},
+      {"ls | gr", 5, "gr", 0, true},
+      {"ls |", 4, "", 0, true},
+      {"ls > fi", 5, "fi", 0, false},
+      {"ls >> fi", 6, "fi", 0, false},
+      {"ls 2>er", 5, "er", 0, false},
+      {"ls >", 4, "", 0, false},
+      {"< in cm", 5, "cm", 0, true},
+      {"cat < in | so", 11, "so", 0, true},
+      {"sort < in -", 10, "-", 0, false},
+  };
+  for (auto const &c : cases) {
+    INFO("line: " << c.line);
+    PartialWord const word = CommandLexer::lastWord(c.line);
+    REQUIRE(word.start == c.start);
+    REQUIRE(word.text == c.text);
+    REQUIRE(word.quote == c.quote);
+    REQUIRE(word.first == c.first);
+  }
+}
+
+TEST_CASE("escaped text is read back as it was", "[escape]") {
+  setVariables();
+  std::vector<std::string> const texts = {
+      "plain",   "a b",       "tab\there", "it's",     "say \"hi\"",
+      "$NAME",   "${NAME}",   "a\\b",      "`tick`",   "~",
+      "~/x",     "a|b<c>d",   "2>x",       "new\nline", "'\"\\$`",
+      "é ü",     "trailing\\"};
+  CommandLexer lexer;
+  for (char const quote : {'\0', '\'', '"'}) {
+    for (auto const &text : texts) {
+      std::string const open = quote ? std::string(1, quote) : "";
+      std::string const line =
+          "cmd " + open + CommandLexer::escape(text, quote);
+      INFO("line: " << line);
+
+      // completion sees the word still being typed as the text.
+      PartialWord const word = CommandLexer::lastWord(line);
+      REQUIRE(word.start == 4);
+      REQUIRE(word.text == text);
+      REQUIRE(word.quote == quote);
+
+      // and once the quote is closed, the command gets it as one argument.
+      REQUIRE(lexer.lex(line + open + " next") == 0);
+      REQUIRE(lexer.argc() == 3);
+      REQUIRE(lexer.argv()[1] == text);
+      REQUIRE_FALSE(lexer.hasOperators());
+    }
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,288 @@
+/**
+ * HistoryStoreTests
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+// Using catch2 headers
+
+#define CATCH_CONFIG_RUNNER
+
+#include "../helpers/HistoryStore.h"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace BlackOS::Trinkets;
+
+namespace {
+/// a directory of its own for each test, removed afterwards.
+struct TempDir {
+  std::filesystem::path path;
+
+  TempDir() {
+    char name[] = "/tmp/HistoryStoreTests.XXXXXX";
+    REQUIRE(mkdtemp(name) != nullptr);
+    path = name;
+  }
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+  }
+};
+
+void writeFile(std::filesystem::path const &path, std::string const &text,
+               bool const append = false) {
+  std::ofstream out(path, append ? std::ios::app : std::ios::trunc);
+  out << text;
+}
+
+std::vector<std::string> entriesOf(HistoryStore const &store) {
+  std::vector<std::string> entries;
+  for (size_t i = 0; i < store.size(); ++i)
+    entries.emplace_back(store.entry(i));
+  return entries;
+}
+
+/// search() done the slow way.
+long reference(std::vector<std::string> const &entries,
+               std::string const &query, size_t const before) {
+  if (query.empty())
+    return -1;
+  for (size_t i = std::min(before, entries.size()); i-- > 0;)
+    if (entries[i].find(query) != std::string::npos)
+      return i;
+  return -1;
+}
+} // namespace
+
+TEST_CASE("appended commands are kept across opens", "[history]") {
+  TempDir dir;
+  auto const log = dir.path / "history.txt";
+  {
+    HistoryStore store;
+    REQUIRE(store.open(log) == 0);
+    REQUIRE(store.size() == 0);
+    REQUIRE(store.append("ls -la") == 0);
+    REQUIRE(store.append("cd /tmp") == 0);
+    REQUIRE(store.append("") == -1);
+    REQUIRE(store.append("echo one\necho two") == -1);
+    REQUIRE(store.append("make -j8") == 0);
+    REQUIRE(entriesOf(store) ==
+            std::vector<std::string>{"ls -la", "cd /tmp", "make -j8"});
+    REQUIRE(store.entry(3).empty());
+  }
+  REQUIRE(std::filesystem::exists(dir.path / "history.idx"));
+
+  HistoryStore store;
+  REQUIRE(store.open(log) == 0);
+  REQUIRE(entriesOf(store) ==
+          std::vector<std::string>{"ls -la", "cd /tmp", "make -j8"});
+  REQUIRE(store.append("git status") == 0);
+  REQUIRE(store.size() == 4);
+  REQUIRE(store.entry(3) == "git status");
+}
+
+TEST_CASE("the index grows past its first capacity", "[history]") {
+  TempDir dir;
+  auto const log = dir.path / "history.txt";
+  std::vector<std::string> expected;
+  {
+    HistoryStore store;
+    REQUIRE(store.open(log) == 0);
+    for (int i = 0; i < 5000; ++i) {
+      expected.push_back("command " + std::to_string(i));
+      REQUIRE(store.append(expected.back()) == 0);
+    }
+    REQUIRE(entriesOf(store) == expected);
+  }
+  HistoryStore store;
+  REQUIRE(store.open(log) == 0);
+  REQUIRE(entriesOf(store) == expected);
+}
+
+TEST_CASE("a log without an index is indexed when opened", "[history]") {
+  TempDir dir;
+  auto const log = dir.path / "history.txt";
+  // blank lines are skipped, and a last line without its newline is left
+  // until it is finished.
+  writeFile(log, "ls\n\n\ncd ..\npwd\nunfini");
+  HistoryStore store;
+  REQUIRE(store.open(log) == 0);
+  REQUIRE(entriesOf(store) == std::vector<std::string>{"ls", "cd ..", "pwd"});
+
+  writeFile(log, "shed\n", true);
+  REQUIRE(store.sync() == 0);
+  REQUIRE(entriesOf(store) ==
+          std::vector<std::string>{"ls", "cd ..", "pwd", "unfinished"});
+}
+
+TEST_CASE("a damaged or stale index is rebuilt from the log", "[history]") {
+  TempDir dir;
+  auto const log = dir.path / "history.txt";
+  auto const index = dir.path / "history.idx";
+  std::vector<std::string> const expected = {"one", "two", "three"};
+  {
+    HistoryStore store;
+    REQUIRE(store.open(log) == 0);
+    for (auto const &command : expected)
+      REQUIRE(store.append(command) == 0);
+  }
+
+  SECTION("deleted") { std::filesystem::remove(index); }
+  SECTION("cut short") { std::filesystem::resize_file(index, 4); }
+  SECTION("not an index") {
+    writeFile(index, std::string(4096, 'x'));
+  }
+  SECTION("counting more entries than it holds") {
+    std::fstream file(index, std::ios::in | std::ios::out | std::ios::binary);
+    uint64_t const entries = 1 << 30;
+    file.seekp(16);
+    file.write(reinterpret_cast<char const *>(&entries), sizeof(entries));
+  }
+  SECTION("covering more of the log than there is") {
+    // the log was replaced by a shorter one.
+    writeFile(log, "a\nb\n");
+    HistoryStore store;
+    REQUIRE(store.open(log) == 0);
+    REQUIRE(entriesOf(store) == std::vector<std::string>{"a", "b"});
+    return;
+  }
+
+  HistoryStore store;
+  REQUIRE(store.open(log) == 0);
+  REQUIRE(entriesOf(store) == expected);
+  REQUIRE(store.append("four") == 0);
+
+  HistoryStore again;
+  REQUIRE(again.open(log) == 0);
+  REQUIRE(entriesOf(again) ==
+          std::vector<std::string>{"one", "two", "three", "four"});
+}
+
+TEST_CASE("shells sharing the files see each other's commands",
+          "[history]") {
+  TempDir dir;
+  auto const log = dir.path / "history.txt";
+  HistoryStore first;
+  HistoryStore second;
+  REQUIRE(first.open(log) == 0);
+  REQUIRE(second.open(log) == 0);
+
+  REQUIRE(first.append("from first") == 0);
+  REQUIRE(second.size() == 0);
+  REQUIRE(second.sync() == 0);
+  REQUIRE(entriesOf(second) == std::vector<std::string>{"from first"});
+
+  REQUIRE(second.append("from second") == 0);
+  REQUIRE(first.append("first again") == 0);
+  REQUIRE(first.sync() == 0);
+  REQUIRE(second.sync() == 0);
+  std::vector<std::string> const expected = {"from first", "from second",
+                                             "first again"};
+  REQUIRE(entriesOf(first) == expected);
+  REQUIRE(entriesOf(second) == expected);
+
+  SECTION("and cope with the log being replaced") {
+    writeFile(log, "replaced\n");
+    // until it syncs, the second shell reads nothing past the new log.
+    REQUIRE(second.entry(2).empty());
+    REQUIRE(second.search("again", second.size()) == -1);
+    REQUIRE(second.sync() == 0);
+    REQUIRE(entriesOf(second) == std::vector<std::string>{"replaced"});
+    REQUIRE(first.sync() == 0);
+    REQUIRE(entriesOf(first) == std::vector<std::string>{"replaced"});
+  }
+}
+
+TEST_CASE("reverse search finds the latest match before a point",
+          "[history]") {
+  TempDir dir;
+  HistoryStore store;
+  REQUIRE(store.open(dir.path / "history.txt") == 0);
+  for (auto const *command : {"git status", "make", "git commit -m wip",
+                              "ls", "git log", "make test"})
+    REQUIRE(store.append(command) == 0);
+
+  REQUIRE(store.search("git", store.size()) == 4);
+  REQUIRE(store.search("git", 4) == 2);
+  REQUIRE(store.search("git", 2) == 0);
+  REQUIRE(store.search("git", 0) == -1);
+  REQUIRE(store.search("make", 100) == 5);
+  REQUIRE(store.search("it c", 6) == 2);
+  REQUIRE(store.search("nothing", 6) == -1);
+  REQUIRE(store.search("", 6) == -1);
+  // a match does not run from one command into the next.
+  REQUIRE(store.search("make\ngit", 6) == -1);
+}
+
+TEST_CASE("reverse search finds a match across the blocks it reads",
+          "[history]") {
+  TempDir dir;
+  HistoryStore store;
+  REQUIRE(store.open(dir.path / "history.txt") == 0);
+  // the log is read back in 64 KiB blocks from its end. a long second
+  // command puts the start of the first block after the end of the log
+  // three bytes into the first command, inside the match.
+  std::string const first = "xneedlex";
+  REQUIRE(store.append(first) == 0);
+  REQUIRE(store.append(std::string((1 << 16) + 1 - first.size(), 'f')) == 0);
+  REQUIRE(store.search("needle", store.size()) == 0);
+}
+
+TEST_CASE("reverse search agrees with a scan over a long history",
+          "[history]") {
+  TempDir dir;
+  HistoryStore store;
+  REQUIRE(store.open(dir.path / "history.txt") == 0);
+  std::mt19937 random(31);
+  std::vector<std::string> entries;
+  // long enough that searches cross the blocks the log is read back in.
+  for (int i = 0; i < 4000; ++i) {
+    std::string command(20 + random() % 200, 'a');
+    for (char &c : command)
+      c = "abcdefgh "[random() % 9];
+    command = "cmd" + std::to_string(i) + " " + command;
+    entries.push_back(command);
+    REQUIRE(store.append(command) == 0);
+  }
+  REQUIRE(store.size() == entries.size());
+
+  for (int i = 0; i < 400; ++i) {
+    std::string query;
+    if (i % 2 == 0) {
+      // part of a command, so that it is found.
+      std::string const &from = entries[random() % entries.size()];
+      size_t const at = random() % from.size();
+      query = from.substr(at, 1 + random() % 12);
+    } else {
+      query = "cmd" + std::to_string(random() % 5000) + " ";
+    }
+    size_t const before = random() % (entries.size() + 10);
+    INFO("query '" << query << "' before " << before);
+    REQUIRE(store.search(query, before) == reference(entries, query, before));
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,330 @@
+/**
+ * LineEditorTests
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+// Using catch2 headers
+
+#define CATCH_CONFIG_RUNNER
+
+#include "../helpers/LineEditor.h"
+#include <catch2/catch.hpp>
+#include <cctype>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace BlackOS::Trinkets;
+
+namespace {
+/// an editor holding text with the cursor at cursor, drawn.
+LineEditor editorWith(std::string const &text, size_t const cursor,
+                      size_t const capacity = 4) {
+  LineEditor editor(capacity);
+  editor.insert(text);
+  editor.moveTo(cursor);
+  editor.markDrawn();
+  return editor;
+}
+
+/// the line with a '|' at the cursor.
+std::string shown(LineEditor const &editor) {
+  std::string line = editor.text();
+  line.insert(editor.cursor(), "|");
+  return line;
+}
+
+bool isBlank(char const c) { return std::isspace((unsigned char)c); }
+
+/// the line as a string, edited the way the editor is meant to edit it.
+struct Model {
+  std::string text;
+  size_t cursor = 0;
+
+  size_t wordStart() const {
+    size_t pos = cursor;
+    while (pos > 0 && isBlank(text[pos - 1]))
+      --pos;
+    while (pos > 0 && !isBlank(text[pos - 1]))
+      --pos;
+    return pos;
+  }
+  size_t wordEnd() const {
+    size_t pos = cursor;
+    while (pos < text.size() && isBlank(text[pos]))
+      ++pos;
+    while (pos < text.size() && !isBlank(text[pos]))
+      ++pos;
+    return pos;
+  }
+};
+} // namespace
+
+TEST_CASE("text is inserted at the cursor as the buffer grows", "[edit]") {
+  LineEditor editor(2);
+  REQUIRE(editor.size() == 0);
+  REQUIRE(editor.text().empty());
+  editor.insert("hello");
+  editor.insert(' ');
+  editor.insert("world");
+  REQUIRE(shown(editor) == "hello world|");
+
+  editor.moveTo(5);
+  editor.insert(",");
+  REQUIRE(shown(editor) == "hello,| world");
+
+  std::string const longText(1000, 'x');
+  editor.insert(longText);
+  REQUIRE(editor.size() == 1012);
+  REQUIRE(editor.cursor() == 1006);
+  REQUIRE(editor.text() == "hello," + longText + " world");
+  REQUIRE(editor.at(1006) == ' ');
+  REQUIRE(editor.slice(1004, 1008) == "xx w");
+}
+
+TEST_CASE("the cursor stays within the line", "[edit]") {
+  LineEditor editor = editorWith("abc", 1);
+  REQUIRE(editor.left());
+  REQUIRE_FALSE(editor.left());
+  REQUIRE(editor.cursor() == 0);
+  editor.end();
+  REQUIRE_FALSE(editor.right());
+  REQUIRE(editor.cursor() == 3);
+  editor.moveTo(100);
+  REQUIRE(editor.cursor() == 3);
+  editor.home();
+  REQUIRE(editor.right());
+  REQUIRE(shown(editor) == "a|bc");
+}
+
+TEST_CASE("deletions at the ends of the line do nothing", "[edit]") {
+  LineEditor editor = editorWith("ab", 0);
+  REQUIRE_FALSE(editor.backspace());
+  REQUIRE_FALSE(editor.deleteWordBefore());
+  REQUIRE(editor.deleteForward());
+  REQUIRE(shown(editor) == "|b");
+  editor.end();
+  REQUIRE_FALSE(editor.deleteForward());
+  REQUIRE(editor.backspace());
+  REQUIRE(shown(editor) == "|");
+  REQUIRE_FALSE(editor.backspace());
+  REQUIRE_FALSE(editor.deleteForward());
+}
+
+TEST_CASE("word motions and deletions", "[edit]") {
+  struct Case {
+    char const *before;
+    char const *wordLeft;
+    char const *wordRight;
+    char const *deleteWord;
+  };
+  // '|' marks the cursor.
+  std::vector<Case> const cases = {
+      {"|", "|", "|", "|"},
+      {"ls -la /tmp|", "ls -la |/tmp", "ls -la /tmp|", "ls -la |"},
+      {"ls -la   |/tmp", "ls |-la   /tmp", "ls -la   /tmp|", "ls |/tmp"},
+      {"ls -l|a /tmp", "ls |-la /tmp", "ls -la| /tmp", "ls |a /tmp"},
+      {"  |  word  ", "|    word  ", "    word|  ", "|  word  "},
+      {"one\ttwo|", "one\t|two", "one\ttwo|", "one\t|"},
+      {"|lead", "|lead", "lead|", "|lead"},
+  };
+  for (auto const &c : cases) {
+    std::string const before = c.before;
+    size_t const cursor = before.find('|');
+    std::string const text =
+        before.substr(0, cursor) + before.substr(cursor + 1);
+    INFO("line: " << before);
+
+    LineEditor editor = editorWith(text, cursor);
+    editor.wordLeft();
+    REQUIRE(shown(editor) == c.wordLeft);
+    editor = editorWith(text, cursor);
+    editor.wordRight();
+    REQUIRE(shown(editor) == c.wordRight);
+    editor = editorWith(text, cursor);
+    editor.deleteWordBefore();
+    REQUIRE(shown(editor) == c.deleteWord);
+  }
+}
+
+TEST_CASE("killing to either end of the line", "[edit]") {
+  LineEditor editor = editorWith("echo hello", 5);
+  editor.killToEnd();
+  REQUIRE(shown(editor) == "echo |");
+  editor.moveTo(2);
+  editor.killToStart();
+  REQUIRE(shown(editor) == "|ho ");
+  editor.clear();
+  REQUIRE(shown(editor) == "|");
+}
+
+TEST_CASE("only the changed part of the line is marked for redrawing",
+          "[redraw]") {
+  LineEditor editor = editorWith("git status", 10);
+  REQUIRE(editor.dirtyFrom() == LineEditor::npos);
+
+  // moving the cursor changes nothing on screen.
+  editor.wordLeft();
+  editor.home();
+  editor.end();
+  REQUIRE(editor.dirtyFrom() == LineEditor::npos);
+
+  editor.backspace();
+  REQUIRE(editor.dirtyFrom() == 9);
+  editor.moveTo(3);
+  editor.insert('x');
+  REQUIRE(editor.dirtyFrom() == 3);
+  editor.end();
+  editor.insert('y');
+  REQUIRE(editor.dirtyFrom() == 3);
+  editor.markDrawn();
+  REQUIRE(editor.dirtyFrom() == LineEditor::npos);
+
+  editor.invalidate(6);
+  REQUIRE(editor.dirtyFrom() == 6);
+  editor.invalidate();
+  REQUIRE(editor.dirtyFrom() == 0);
+}
+
+TEST_CASE("assigning a line redraws from where it differs", "[redraw]") {
+  LineEditor editor = editorWith("git status", 2);
+  editor.assign("git stash pop");
+  REQUIRE(shown(editor) == "git stash pop|");
+  REQUIRE(editor.dirtyFrom() == 7);
+
+  editor.markDrawn();
+  editor.moveTo(4);
+  editor.assign("git stash pop");
+  REQUIRE(shown(editor) == "git stash pop|");
+  REQUIRE(editor.dirtyFrom() == LineEditor::npos);
+
+  editor.assign("git");
+  REQUIRE(shown(editor) == "git|");
+  REQUIRE(editor.dirtyFrom() == 3);
+
+  editor.markDrawn();
+  editor.assign("");
+  REQUIRE(shown(editor) == "|");
+  REQUIRE(editor.dirtyFrom() == 0);
+}
+
+TEST_CASE("random edits match a plain string", "[edit][redraw]") {
+  std::mt19937 random(35);
+  LineEditor editor(1);
+  Model model;
+  std::string drawn;
+  for (int step = 0; step < 100000; ++step) {
+    int const op = random() % 16;
+    std::string const text(random() % 4, "ab \t"[random() % 4]);
+    switch (op) {
+    case 0:
+    case 1:
+    case 2:
+      editor.insert(text);
+      model.text.insert(model.cursor, text);
+      model.cursor += text.size();
+      break;
+    case 3:
+      REQUIRE(editor.backspace() == (model.cursor > 0));
+      if (model.cursor > 0)
+        model.text.erase(--model.cursor, 1);
+      break;
+    case 4:
+      REQUIRE(editor.deleteForward() == (model.cursor < model.text.size()));
+      if (model.cursor < model.text.size())
+        model.text.erase(model.cursor, 1);
+      break;
+    case 5: {
+      size_t const start = model.wordStart();
+      REQUIRE(editor.deleteWordBefore() == (start < model.cursor));
+      model.text.erase(start, model.cursor - start);
+      model.cursor = start;
+      break;
+    }
+    case 6:
+      editor.wordLeft();
+      model.cursor = model.wordStart();
+      break;
+    case 7:
+      editor.wordRight();
+      model.cursor = model.wordEnd();
+      break;
+    case 8:
+      REQUIRE(editor.left() == (model.cursor > 0));
+      model.cursor -= model.cursor > 0;
+      break;
+    case 9:
+      REQUIRE(editor.right() == (model.cursor < model.text.size()));
+      model.cursor += model.cursor < model.text.size();
+      break;
+    case 10: {
+      size_t const pos = random() % (model.text.size() + 3);
+      editor.moveTo(pos);
+      model.cursor = std::min(pos, model.text.size());
+      break;
+    }
+    case 11:
+      if (random() % 8 == 0) {
+        editor.killToStart();
+        model.text.erase(0, model.cursor);
+        model.cursor = 0;
+      } else {
+        editor.killToEnd();
+        model.text.erase(model.cursor);
+      }
+      break;
+    case 12: {
+      // a line from history or completion, often sharing a prefix.
+      std::string line =
+          model.text.substr(0, random() % (model.text.size() + 1)) + text;
+      editor.assign(line);
+      model.text = line;
+      model.cursor = line.size();
+      break;
+    }
+    case 13:
+      if (random() % 64 == 0) {
+        editor.clear();
+        model.text.clear();
+        model.cursor = 0;
+      }
+      break;
+    default:
+      // draw the line; everything before dirtyFrom() must be as drawn.
+      size_t const dirty = editor.dirtyFrom();
+      std::string const now = editor.text();
+      if (dirty == LineEditor::npos) {
+        REQUIRE(now == drawn);
+      } else {
+        REQUIRE(dirty <= std::min(now.size(), drawn.size()));
+        REQUIRE(now.compare(0, dirty, drawn, 0, dirty) == 0);
+      }
+      editor.markDrawn();
+      drawn = now;
+      break;
+    }
+    REQUIRE(editor.text() == model.text);
+    REQUIRE(editor.cursor() == model.cursor);
+    REQUIRE(editor.size() == model.text.size());
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,183 @@
+/**
+ * ListingFormatTests
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+// Using catch2 headers
+
+#define CATCH_CONFIG_RUNNER
+
+#include "../helpers/ListingFormat.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using namespace BlackOS::Trinkets;
+
+namespace {
+/// run the rest of a test in zone. the zone is set through TZ, so the test
+/// does not depend on the zone of the machine it runs on.
+bool useZone(char const *zone) {
+  setenv("TZ", zone, 1);
+  tzset();
+  // without the zone's data, localtime quietly falls back to UTC.
+  time_t const july = 1593561600; // 2020-07-01
+  struct tm local;
+  localtime_r(&july, &local);
+  return std::string(zone) == "UTC" || local.tm_gmtoff != 0 ||
+         std::string(local.tm_zone) != "UTC";
+}
+
+/// what listings showed before the formatter kept spans.
+std::string reference(int64_t const time) {
+  time_t const t = time;
+  struct tm local;
+  char buffer[DateFormatter::MAX_LENGTH];
+  if (localtime_r(&t, &local) == nullptr)
+    return "";
+  return std::string(
+      buffer, strftime(buffer, sizeof(buffer), "%d-%m-%Y %H:%M  %Z", &local));
+}
+
+long offsetAt(int64_t const time) {
+  time_t const t = time;
+  struct tm local;
+  localtime_r(&t, &local);
+  return local.tm_gmtoff;
+}
+
+/// the times from 1970 to 2040 at which the zone changes its UTC offset.
+std::vector<int64_t> transitions() {
+  std::vector<int64_t> found;
+  int64_t const end = 2208988800; // 2040
+  long offset = offsetAt(0);
+  for (int64_t hour = 3600; hour < end; hour += 3600) {
+    if (offsetAt(hour) == offset)
+      continue;
+    int64_t at = hour - 3600;
+    while (offsetAt(at) == offset)
+      at += 60;
+    found.push_back(at);
+    offset = offsetAt(hour);
+  }
+  return found;
+}
+
+/// every minute, and a few seconds around it, for three hours either side of
+/// each change of offset, and times spread over 1901 to 2200, in an order
+/// that moves between days so the spans kept are replaced as they would be
+/// in a listing.
+std::vector<int64_t> timesFor(std::vector<int64_t> const &changes) {
+  std::mt19937_64 random(49);
+  std::vector<int64_t> times;
+  for (int64_t const change : changes)
+    for (int64_t t = change - 3 * 3600; t <= change + 3 * 3600; t += 60)
+      for (int64_t const second : {-1, 0, 1, 59})
+        times.push_back(t + second);
+  for (size_t i = 0; i < 200000; ++i)
+    times.push_back(static_cast<int64_t>(random() % 9467280000ull) -
+                    2147483648ll);
+  std::shuffle(times.begin() + times.size() / 2, times.end(), random);
+  return times;
+}
+
+void checkZone(char const *zone, bool const hasChanges) {
+  INFO("TZ=" << zone);
+  if (!useZone(zone)) {
+    WARN("no time zone data for " << zone << "; not checked");
+    return;
+  }
+  std::vector<int64_t> const changes = transitions();
+  REQUIRE(changes.empty() != hasChanges);
+
+  DateFormatter dates;
+  size_t mismatches = 0;
+  int64_t first = 0;
+  for (int64_t const time : timesFor(changes)) {
+    if (dates.format(time) != reference(time) && mismatches++ == 0)
+      first = time;
+  }
+  INFO("first mismatch at " << first << ": " << dates.format(first)
+                            << " rather than " << reference(first));
+  REQUIRE(mismatches == 0);
+}
+} // namespace
+
+TEST_CASE("dates match localtime and strftime in zones without changes",
+          "[dates]") {
+  checkZone("UTC", false);
+  checkZone("Asia/Kolkata", false); // +05:30; last changed in 1945
+}
+
+TEST_CASE("dates match localtime and strftime across daylight saving",
+          "[dates]") {
+  checkZone("Europe/London", true);
+  checkZone("America/New_York", true);
+  checkZone("America/St_Johns", true); // -03:30
+  checkZone("Australia/Lord_Howe", true); // moves by 30 minutes
+  checkZone("Pacific/Chatham", true);     // +12:45
+}
+
+TEST_CASE("dates follow the half-hour change on Lord Howe Island", "[dates]") {
+  if (!useZone("Australia/Lord_Howe")) {
+    WARN("no time zone data for Australia/Lord_Howe; not checked");
+    return;
+  }
+  // 2020-10-04 02:00, when the island moved from +10:30 to +11:00.
+  int64_t const change = 1601739000;
+  DateFormatter dates;
+  REQUIRE(dates.format(change - 60) == "04-10-2020 01:59  +1030");
+  REQUIRE(dates.format(change) == "04-10-2020 02:30  +11");
+  REQUIRE(dates.format(change + 3600) == "04-10-2020 03:30  +11");
+}
+
+TEST_CASE("permission strings cover every mode", "[permissions]") {
+  for (uint16_t mode = 0; mode < 01000; ++mode) {
+    std::string expected;
+    for (int shift = 6; shift >= 0; shift -= 3) {
+      expected += mode >> shift & 4 ? 'r' : '-';
+      expected += mode >> shift & 2 ? 'w' : '-';
+      expected += mode >> shift & 1 ? 'x' : '-';
+    }
+    INFO("mode " << mode);
+    REQUIRE(permissionString(mode) == expected);
+  }
+  // the file type and the set-id and sticky bits are not shown.
+  REQUIRE(permissionString(0104755) == std::string("rwxr-xr-x"));
+}
+
+TEST_CASE("columns are padded by code points", "[columns]") {
+  std::string line = "|";
+  appendColumn(line, "ab", 4);
+  appendColumn(line, "\xc3\xa9t\xc3\xa9", 5);       // été: 3 code points
+  appendColumn(line, "\xe6\x97\xa5\xe6\x9c\xac", 3); // two CJK code points
+  appendColumn(line, "\xf0\x9f\x93\x81", 2);         // one 4-byte code point
+  appendColumn(line, "longer than the column", 4);
+  appendColumn(line, "", 2);
+  REQUIRE(line == "|ab  \xc3\xa9t\xc3\xa9  \xe6\x97\xa5\xe6\x9c\xac "
+                  "\xf0\x9f\x93\x81 longer than the column  ");
+}
+
+int main(int argc, char const *argv[]) {
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,228 @@
+/**
+ * ListingSortTests
+ *
+ * Copyright (C) 2020, Takudzwa Makoni <https://github.com/TakudzwaMakoni>
+ *
+ * This Program is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This Program is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with This Program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ */
+
+// Using catch2 headers
+
+#define CATCH_CONFIG_RUNNER
+
+#include "../helpers/ListingSort.h"
+#include "../helpers/PathController.h"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace BlackOS::Trinkets;
+
+namespace {
+// the orders are checked against std::stable_sort with comparators written
+// from their description, not from the collation keys the sort builds.
+
+unsigned char fold(unsigned char const c) {
+  return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+bool isDigit(char const c) { return c >= '0' && c <= '9'; }
+
+/// names ignoring case, byte by byte; a name sorts before its extensions.
+bool nameLess(std::string_view const a, std::string_view const b) {
+  return std::lexicographical_compare(
+      a.begin(), a.end(), b.begin(), b.end(), [](char const x, char const y) {
+        return fold(x) < fold(y);
+      });
+}
+
+/// as nameLess, but runs of digits compare as numbers, ignoring leading
+/// zeros, and before any letter.
+bool naturalLess(std::string_view const a, std::string_view const b) {
+  size_t i = 0, j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (isDigit(a[i]) && isDigit(b[j])) {
+      auto const number = [](std::string_view const s, size_t &pos) {
+        while (pos + 1 < s.size() && s[pos] == '0' && isDigit(s[pos + 1]))
+          ++pos;
+        size_t const begin = pos;
+        while (pos < s.size() && isDigit(s[pos]))
+          ++pos;
+        return s.substr(begin, pos - begin);
+      };
+      std::string_view const x = number(a, i);
+      std::string_view const y = number(b, j);
+      if (x.size() != y.size())
+        return x.size() < y.size();
+      if (x != y)
+        return x < y;
+      continue;
+    }
+    unsigned char const x = isDigit(a[i]) ? '0' : fold(a[i]);
+    unsigned char const y = isDigit(b[j]) ? '0' : fold(b[j]);
+    if (x != y)
+      return x < y;
+    ++i;
+    ++j;
+  }
+  return i == a.size() && j < b.size();
+}
+
+std::vector<uint32_t> reference(PathEntries const &entries,
+                                SortOrder const order) {
+  std::vector<uint32_t> sorted(entries.size());
+  std::iota(sorted.begin(), sorted.end(), 0);
+  bool const natural = order == SortOrder::NATURAL;
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [&](uint32_t const a, uint32_t const b) {
+                     return natural ? naturalLess(entries.name(a),
+                                                  entries.name(b))
+                                    : nameLess(entries.name(a),
+                                               entries.name(b));
+                   });
+  auto const typeRank = [&](uint32_t const idx) {
+    PathType const type = entries.types[idx];
+    return type == PathType::DIRECTORY ? 0 : type == PathType::FILE ? 1 : 2;
+  };
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [&](uint32_t const a, uint32_t const b) {
+                     switch (order) {
+                     case SortOrder::MTIME:
+                       return entries.mtimes[a] > entries.mtimes[b];
+                     case SortOrder::SIZE:
+                       return entries.sizes[a] > entries.sizes[b];
+                     case SortOrder::TYPE:
+                       return typeRank(a) < typeRank(b);
+                     default:
+                       return false;
+                     }
+                   });
+  return sorted;
+}
+
+/// entries with the given names and random types, times and sizes, with
+/// plenty of ties in each.
+PathEntries entriesOf(std::vector<std::string> const &names,
+                      std::mt19937 &random) {
+  PathEntries entries;
+  for (auto const &name : names)
+    entries.push(name, static_cast<PathType>(random() % 4));
+  entries.makeMetadata();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    entries.mtimes[i] = static_cast<int64_t>(random() % 64) - 32;
+    entries.sizes[i] = random() % 3 == 0 ? random() : random() % 16;
+  }
+  return entries;
+}
+
+std::string randomName(std::mt19937 &random, size_t const maxLen) {
+  static char const alphabet[] = "aAbBzZ019._- \xc3\xa9";
+  size_t const len = 1 + random() % maxLen;
+  std::string name;
+  for (size_t i = 0; i < len; ++i)
+    name += alphabet[random() % (sizeof(alphabet) - 1)];
+  return name;
+}
+
+void checkEveryOrder(std::vector<std::string> const &names,
+                     std::mt19937 &random) {
+  PathEntries const entries = entriesOf(names, random);
+  for (size_t o = 0; o < SORT_ORDERS; ++o) {
+    SortOrder const order = static_cast<SortOrder>(o);
+    INFO("order " << sortOrderName(order) << ", " << names.size()
+                  << " names");
+    REQUIRE(sortListing(entries, order) == reference(entries, order));
+  }
+}
+
+std::vector<std::string> sortedNames(std::vector<std::string> const &names,
+                                     SortOrder const order) {
+  std::mt19937 random(1);
+  PathEntries const entries = entriesOf(names, random);
+  std::vector<std::string> sorted;
+  for (uint32_t const idx : sortListing(entries, order))
+    sorted.emplace_back(entries.name(idx));
+  return sorted;
+}
+} // namespace
+
+TEST_CASE("random names sort as the reference in every order", "[sort]") {
+  std::mt19937 random(44);
+  // below, at and above the size insertion sort takes over, and enough for
+  // several levels of buckets.
+  for (size_t const count : {0, 1, 2, 31, 32, 33, 500, 20000}) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; ++i)
+      names.push_back(randomName(random, 24));
+    checkEveryOrder(names, random);
+  }
+}
+
+TEST_CASE("names sharing a long prefix sort as the reference", "[sort]") {
+  std::mt19937 random(45);
+  // longer than the sixteen bytes each pass of the sort looks at, with
+  // names that end inside it, that differ only in case, and whose numbers
+  // straddle the prefix.
+  std::string const prefix(37, 'p');
+  std::vector<std::string> names;
+  for (size_t i = 0; i < 3000; ++i) {
+    std::string name = prefix.substr(0, 30 + random() % 8);
+    name += randomName(random, 12);
+    if (random() % 4 == 0)
+      std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    names.push_back(name);
+  }
+  names.push_back(prefix);
+  names.push_back(prefix);
+  names.push_back(prefix.substr(0, 15) + "123456789012345678901234");
+  names.push_back(prefix.substr(0, 15) + "123456789012345678901235");
+  checkEveryOrder(names, random);
+}
+
+TEST_CASE("natural order compares numbers by value", "[sort]") {
+  std::vector<std::string> const names = {"file10", "file9", "file010",
+                                          "File2", "file", "file9a",
+                                          "file1.txt"};
+  REQUIRE(sortedNames(names, SortOrder::NATURAL) ==
+          std::vector<std::string>{"file", "file1.txt", "File2", "file9",
+                                   "file9a", "file10", "file010"});
+  REQUIRE(sortedNames(names, SortOrder::NAME) ==
+          std::vector<std::string>{"file", "file010", "file1.txt", "file10",
+                                   "File2", "file9", "file9a"});
+}
+
+TEST_CASE("metadata orders keep names in order for ties", "[sort]") {
+  PathEntries entries;
+  for (char const *name : {"b", "a", "c", "d"})
+    entries.push(name, PathType::FILE);
+  entries.types[2] = PathType::DIRECTORY;
+  entries.makeMetadata();
+  entries.mtimes = {5, -1, 5, 7};
+  entries.sizes = {1, 1, 9, 1};
+  REQUIRE(sortListing(entries, SortOrder::MTIME) ==
+          std::vector<uint32_t>{3, 0, 2, 1});
+  REQUIRE(sortListing(entries, SortOrder::SIZE) ==
+          std::vector<uint32_t>{2, 1, 0, 3});
+  REQUIRE(sortListing(entries, SortOrder::TYPE) ==
+          std::vector<uint32_t>{2, 1, 0, 3});
+}
+
+int main(int argc, char const *argv[]) {
+  return Catch::Session().run(argc, argv);
+}